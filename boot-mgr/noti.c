@@ -0,0 +1,194 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <heynoti.h>
+
+#include "noti.h"
+#include "lockd-debug.h"
+#include "lockd-wakeup.h"
+
+#define NOTI_NAME_MAX		64
+#define NOTI_EVENT_MAX		8
+#define NOTI_HANDLER_MAX	4
+
+struct noti_handler {
+	starter_noti_cb cb;
+	void *data;
+};
+
+struct noti_event {
+	char name[NOTI_NAME_MAX];
+	int n_handlers;
+	struct noti_handler handler[NOTI_HANDLER_MAX];
+};
+
+static struct {
+	int fd;
+	struct noti_event event[NOTI_EVENT_MAX];
+} noti = {
+	.fd = -1,
+};
+
+static void _noti_dispatch(void *data)
+{
+	struct noti_event *ev = data;
+	struct noti_handler handler[NOTI_HANDLER_MAX];
+	int n;
+	int i;
+
+	if (ev == NULL)
+		return;
+
+	lockd_wakeup_source(ev->name);
+
+	/* handlers may unsubscribe themselves while we walk the table */
+	n = ev->n_handlers;
+	memcpy(handler, ev->handler, sizeof(struct noti_handler) * n);
+
+	_DBG("noti [%s] : %d handler(s)", ev->name, n);
+
+	for (i = 0; i < n; i++)
+		handler[i].cb(handler[i].data);
+}
+
+static struct noti_event *_noti_find(const char *event)
+{
+	int i;
+
+	for (i = 0; i < NOTI_EVENT_MAX; i++) {
+		if (noti.event[i].name[0] != '\0'
+		    && strcmp(noti.event[i].name, event) == 0)
+			return &noti.event[i];
+	}
+
+	return NULL;
+}
+
+int starter_noti_init(void)
+{
+	int r;
+
+	if (noti.fd != -1)
+		return 0;
+
+	noti.fd = heynoti_init();
+	if (noti.fd < 0) {
+		_ERR("Failed to heynoti_init[%d]", noti.fd);
+		noti.fd = -1;
+		return -1;
+	}
+
+	r = heynoti_attach_handler(noti.fd);
+	if (r < 0) {
+		_ERR("Failed to heynoti_attach_handler[%d]", r);
+		heynoti_close(noti.fd);
+		noti.fd = -1;
+		return -1;
+	}
+
+	return 0;
+}
+
+int starter_noti_subscribe(const char *event, starter_noti_cb cb, void *data)
+{
+	struct noti_event *ev;
+	int r;
+	int i;
+
+	if (noti.fd == -1 || event == NULL || cb == NULL)
+		return -1;
+
+	if (strlen(event) >= NOTI_NAME_MAX) {
+		_ERR("noti name is too long [%s]", event);
+		return -1;
+	}
+
+	ev = _noti_find(event);
+	if (ev == NULL) {
+		for (i = 0; i < NOTI_EVENT_MAX; i++) {
+			if (noti.event[i].name[0] == '\0')
+				break;
+		}
+		if (i == NOTI_EVENT_MAX) {
+			_ERR("noti table is full, cannot add [%s]", event);
+			return -1;
+		}
+
+		ev = &noti.event[i];
+		r = heynoti_subscribe(noti.fd, event, _noti_dispatch, ev);
+		if (r < 0) {
+			_ERR("Failed to heynoti_subscribe[%s][%d]", event, r);
+			return -1;
+		}
+		snprintf(ev->name, NOTI_NAME_MAX, "%s", event);
+		ev->n_handlers = 0;
+	}
+
+	if (ev->n_handlers == NOTI_HANDLER_MAX) {
+		_ERR("too many handlers for [%s]", event);
+		return -1;
+	}
+
+	ev->handler[ev->n_handlers].cb = cb;
+	ev->handler[ev->n_handlers].data = data;
+	ev->n_handlers++;
+
+	return 0;
+}
+
+int starter_noti_unsubscribe(const char *event, starter_noti_cb cb,
+			     void *data)
+{
+	struct noti_event *ev;
+	int i;
+
+	if (noti.fd == -1 || event == NULL)
+		return -1;
+
+	ev = _noti_find(event);
+	if (ev == NULL)
+		return -1;
+
+	for (i = 0; i < ev->n_handlers; i++) {
+		if (ev->handler[i].cb == cb && ev->handler[i].data == data)
+			break;
+	}
+	if (i == ev->n_handlers)
+		return -1;
+
+	memmove(&ev->handler[i], &ev->handler[i + 1],
+		sizeof(struct noti_handler) * (ev->n_handlers - i - 1));
+	ev->n_handlers--;
+
+	if (ev->n_handlers == 0) {
+		heynoti_unsubscribe(noti.fd, ev->name, _noti_dispatch);
+		ev->name[0] = '\0';
+	}
+
+	return 0;
+}
+
+void starter_noti_fini(void)
+{
+	if (noti.fd == -1)
+		return;
+
+	heynoti_close(noti.fd);
+	noti.fd = -1;
+	memset(noti.event, 0, sizeof(noti.event));
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __STARTER_NOTI_H__
+#define __STARTER_NOTI_H__
+
+/*
+ * All heynoti events starter listens to go through one heynoti fd and one
+ * attached handler. Subscribers register per event name and are called
+ * from the dispatch table in subscription order.
+ */
+
+typedef void (*starter_noti_cb) (void *data);
+
+int starter_noti_init(void);
+
+int starter_noti_subscribe(const char *event, starter_noti_cb cb, void *data);
+
+int starter_noti_unsubscribe(const char *event, starter_noti_cb cb,
+			     void *data);
+
+void starter_noti_fini(void);
+
+#endif				/* __STARTER_NOTI_H__ */
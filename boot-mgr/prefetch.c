@@ -0,0 +1,470 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+#include <linux/fiemap.h>
+
+#include "prefetch.h"
+#include "lockd-debug.h"
+
+#define PREFETCH_MAP_MAX	1024
+#define PREFETCH_LINE_MAX	(PATH_MAX + 64)
+/* a hole this small costs less to read through than another request */
+#define PREFETCH_MERGE_GAP	(32 * 1024)
+
+struct prefetch_map {
+	unsigned long start;
+	unsigned long end;
+	unsigned long offset;
+	char *path;
+	unsigned char *vec;	/* one mincore byte per page */
+};
+
+struct starter_prefetch_snapshot {
+	int n_maps;
+	struct prefetch_map map[PREFETCH_MAP_MAX];
+};
+
+struct prefetch_range {
+	unsigned long offset;
+	unsigned long length;
+	const char *path;
+	unsigned long long physical;	/* of the file's first range */
+};
+
+struct prefetch_ranges {
+	int n;
+	int size;
+	struct prefetch_range *range;
+};
+
+static long _page_size(void)
+{
+	static long page_size = 0;
+
+	if (page_size == 0)
+		page_size = sysconf(_SC_PAGESIZE);
+
+	return page_size;
+}
+
+/* file backed, readable mappings of /proc/self/maps */
+static int _prefetch_parse_map(const char *line, struct prefetch_map *m)
+{
+	char perms[8];
+	const char *path;
+	int n = 0;
+
+	if (sscanf(line, "%lx-%lx %7s %lx %*s %*s %n", &m->start, &m->end,
+		   perms, &m->offset, &n) < 4 || n == 0)
+		return -1;
+
+	if (perms[0] != 'r')
+		return -1;
+
+	path = line + n;
+	if (path[0] != '/' || strstr(path, " (deleted)") != NULL)
+		return -1;
+
+	m->path = strndup(path, strcspn(path, "\n"));
+	if (m->path == NULL)
+		return -1;
+
+	return 0;
+}
+
+struct starter_prefetch_snapshot *starter_prefetch_snapshot(void)
+{
+	struct starter_prefetch_snapshot *snap;
+	struct prefetch_map *m;
+	char line[PREFETCH_LINE_MAX];
+	size_t pages;
+	FILE *fp;
+
+	snap = calloc(1, sizeof(struct starter_prefetch_snapshot));
+	if (snap == NULL)
+		return NULL;
+
+	fp = fopen("/proc/self/maps", "r");
+	if (fp == NULL) {
+		_ERR("Cannot open /proc/self/maps");
+		free(snap);
+		return NULL;
+	}
+
+	while (snap->n_maps < PREFETCH_MAP_MAX
+	       && fgets(line, sizeof(line), fp) != NULL) {
+		m = &snap->map[snap->n_maps];
+		if (_prefetch_parse_map(line, m) < 0)
+			continue;
+
+		pages = (m->end - m->start) / _page_size();
+		m->vec = malloc(pages);
+		if (m->vec == NULL
+		    || mincore((void *)m->start, m->end - m->start,
+			       m->vec) < 0) {
+			free(m->vec);
+			free(m->path);
+			memset(m, 0, sizeof(struct prefetch_map));
+			continue;
+		}
+		snap->n_maps++;
+	}
+	fclose(fp);
+
+	return snap;
+}
+
+void starter_prefetch_snapshot_free(struct starter_prefetch_snapshot *snap)
+{
+	int i;
+
+	if (snap == NULL)
+		return;
+
+	for (i = 0; i < snap->n_maps; i++) {
+		free(snap->map[i].path);
+		free(snap->map[i].vec);
+	}
+	free(snap);
+}
+
+static const struct prefetch_map *
+_prefetch_find(const struct starter_prefetch_snapshot *snap,
+	       const struct prefetch_map *m)
+{
+	int i;
+
+	if (snap == NULL)
+		return NULL;
+
+	for (i = 0; i < snap->n_maps; i++) {
+		if (snap->map[i].start == m->start
+		    && snap->map[i].end == m->end
+		    && strcmp(snap->map[i].path, m->path) == 0)
+			return &snap->map[i];
+	}
+
+	return NULL;
+}
+
+static int _prefetch_add(struct prefetch_ranges *r, unsigned long offset,
+			 unsigned long length, const char *path)
+{
+	struct prefetch_range *range;
+
+	if (r->n == r->size) {
+		range = realloc(r->range, (r->size + 256)
+				* sizeof(struct prefetch_range));
+		if (range == NULL)
+			return -1;
+		r->range = range;
+		r->size += 256;
+	}
+
+	range = &r->range[r->n++];
+	range->offset = offset;
+	range->length = length;
+	range->path = path;
+	range->physical = 0;
+
+	return 0;
+}
+
+/* pages of m resident now but not in old, as file ranges */
+static int _prefetch_collect_map(struct prefetch_ranges *r,
+				 const struct prefetch_map *m,
+				 const struct prefetch_map *old)
+{
+	size_t pages = (m->end - m->start) / _page_size();
+	size_t i, run = 0;
+
+	for (i = 0; i <= pages; i++) {
+		if (i < pages && (m->vec[i] & 1)
+		    && !(old && (old->vec[i] & 1))) {
+			run++;
+			continue;
+		}
+		if (run == 0)
+			continue;
+
+		if (_prefetch_add(r, m->offset + (i - run) * _page_size(),
+				  run * _page_size(), m->path) < 0)
+			return -1;
+		run = 0;
+	}
+
+	return 0;
+}
+
+static int _prefetch_cmp_file(const void *a, const void *b)
+{
+	const struct prefetch_range *ra = a, *rb = b;
+	int c;
+
+	c = strcmp(ra->path, rb->path);
+	if (c != 0)
+		return c;
+
+	return ra->offset < rb->offset ? -1 : ra->offset > rb->offset;
+}
+
+static int _prefetch_cmp_disk(const void *a, const void *b)
+{
+	const struct prefetch_range *ra = a, *rb = b;
+
+	if (ra->physical != rb->physical)
+		return ra->physical < rb->physical ? -1 : 1;
+
+	return _prefetch_cmp_file(a, b);
+}
+
+/* where the file starts on disk, 0 if the file system cannot tell */
+static unsigned long long _prefetch_physical(int fd, unsigned long offset)
+{
+	union {
+		struct fiemap map;
+		char buf[sizeof(struct fiemap) + sizeof(struct fiemap_extent)];
+	} u;
+
+	memset(&u, 0, sizeof(u));
+	u.map.fm_start = offset;
+	u.map.fm_length = _page_size();
+	u.map.fm_extent_count = 1;
+
+	if (ioctl(fd, FS_IOC_FIEMAP, &u.map) < 0
+	    || u.map.fm_mapped_extents == 0)
+		return 0;
+
+	return u.map.fm_extents[0].fe_physical;
+}
+
+/*
+ * One file's ranges : merged over small holes, and dropped unless the file
+ * is a regular one (no device node is opened again on replay).
+ * Returns the number of ranges kept, which are moved to the front.
+ */
+static int _prefetch_merge_file(struct prefetch_range *range, int n)
+{
+	unsigned long long physical;
+	struct stat st;
+	int fd;
+	int i, m;
+
+	fd = open(range[0].path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return 0;
+	if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+		close(fd);
+		return 0;
+	}
+	physical = _prefetch_physical(fd, range[0].offset);
+	close(fd);
+
+	for (i = 1, m = 0; i < n; i++) {
+		if (range[i].offset
+		    <= range[m].offset + range[m].length + PREFETCH_MERGE_GAP) {
+			if (range[i].offset + range[i].length
+			    > range[m].offset + range[m].length)
+				range[m].length = range[i].offset
+				    + range[i].length - range[m].offset;
+			continue;
+		}
+		range[++m] = range[i];
+	}
+	for (i = 0; i <= m; i++)
+		range[i].physical = physical;
+
+	return m + 1;
+}
+
+/*
+ * Merge the ranges of each file and order the files by where they sit on
+ * the disk, so replay issues few, large and mostly sequential reads.
+ */
+static void _prefetch_order(struct prefetch_ranges *r)
+{
+	int i, j, n = 0;
+
+	qsort(r->range, r->n, sizeof(struct prefetch_range),
+	      _prefetch_cmp_file);
+
+	for (i = 0; i < r->n; i = j) {
+		for (j = i + 1; j < r->n
+		     && strcmp(r->range[j].path, r->range[i].path) == 0; j++) ;
+		if (i != n)
+			memmove(&r->range[n], &r->range[i],
+				(j - i) * sizeof(struct prefetch_range));
+		n += _prefetch_merge_file(&r->range[n], j - i);
+	}
+	r->n = n;
+
+	qsort(r->range, r->n, sizeof(struct prefetch_range),
+	      _prefetch_cmp_disk);
+}
+
+int starter_prefetch_record(const struct starter_prefetch_snapshot *before,
+			    const char *manifest)
+{
+	struct starter_prefetch_snapshot *after;
+	struct prefetch_ranges r = { 0, 0, NULL };
+	unsigned long total = 0;
+	char tmp[PATH_MAX];
+	FILE *fp;
+	int i;
+
+	after = starter_prefetch_snapshot();
+	if (after == NULL)
+		return -1;
+
+	for (i = 0; i < after->n_maps; i++) {
+		if (_prefetch_collect_map(&r, &after->map[i],
+					  _prefetch_find(before,
+							 &after->map[i])) < 0) {
+			_ERR("Cannot collect prefetch ranges");
+			break;
+		}
+	}
+	_prefetch_order(&r);
+
+	snprintf(tmp, sizeof(tmp), "%s.tmp", manifest);
+	fp = fopen(tmp, "w");
+	if (fp == NULL) {
+		_ERR("Cannot write %s", tmp);
+		free(r.range);
+		starter_prefetch_snapshot_free(after);
+		return -1;
+	}
+
+	for (i = 0; i < r.n; i++) {
+		fprintf(fp, "%lu %lu %s\n", r.range[i].offset,
+			r.range[i].length, r.range[i].path);
+		total += r.range[i].length;
+	}
+
+	free(r.range);
+	starter_prefetch_snapshot_free(after);
+
+	if (fclose(fp) != 0 || rename(tmp, manifest) < 0) {
+		_ERR("Cannot write %s", manifest);
+		unlink(tmp);
+		return -1;
+	}
+
+	_DBG("prefetch manifest %s : %d ranges, %lu kB", manifest, r.n,
+	     total / 1024);
+
+	return r.n;
+}
+
+static void *_prefetch_thread(void *data)
+{
+	char *manifest = data;
+	char line[PREFETCH_LINE_MAX];
+	char path[PATH_MAX] = "";
+	unsigned long offset, length;
+	unsigned long total = 0;
+	int ranges = 0;
+	int fd = -1;
+	int n;
+	FILE *fp;
+
+	fp = fopen(manifest, "r");
+	if (fp == NULL) {
+		free(manifest);
+		return NULL;
+	}
+
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		n = 0;
+		if (sscanf(line, "%lu %lu %n", &offset, &length, &n) < 2
+		    || n == 0)
+			continue;
+		line[n + strcspn(line + n, "\n")] = '\0';
+
+		/* ranges of one file are written together */
+		if (strcmp(path, line + n) != 0) {
+			if (fd >= 0)
+				close(fd);
+			snprintf(path, sizeof(path), "%s", line + n);
+			fd = open(path, O_RDONLY | O_CLOEXEC);
+		}
+		if (fd < 0)
+			continue;
+
+		if (readahead(fd, offset, length) == 0) {
+			total += length;
+			ranges++;
+		}
+	}
+	if (fd >= 0)
+		close(fd);
+	fclose(fp);
+
+	_DBG("prefetched %d ranges, %lu kB from %s", ranges, total / 1024,
+	     manifest);
+	free(manifest);
+
+	return NULL;
+}
+
+int starter_prefetch_start(const char *manifest)
+{
+	pthread_attr_t attr;
+	pthread_t tid;
+	char *path;
+	int r;
+
+	if (access(manifest, R_OK) != 0)
+		return -1;
+
+	path = strdup(manifest);
+	if (path == NULL)
+		return -1;
+
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	r = pthread_create(&tid, &attr, _prefetch_thread, path);
+	pthread_attr_destroy(&attr);
+	if (r != 0) {
+		_ERR("Cannot start prefetch thread (%d)", r);
+		free(path);
+		return -1;
+	}
+
+	return 0;
+}
+
+long starter_prefetch_major_faults(void)
+{
+	struct rusage ru;
+
+	if (getrusage(RUSAGE_SELF, &ru) < 0)
+		return 0;
+
+	return ru.ru_majflt;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __STARTER_PREFETCH_H__
+#define __STARTER_PREFETCH_H__
+
+/*
+ * Working set prefetch.
+ *
+ * Training : take a snapshot of which pages of starter's file mappings are
+ * in the page cache (mincore), run the path to train, then record every
+ * page that became resident into a manifest :
+ *
+ *	struct starter_prefetch_snapshot *snap = starter_prefetch_snapshot();
+ *	...path...
+ *	starter_prefetch_record(snap, manifest);
+ *	starter_prefetch_snapshot_free(snap);
+ *
+ * Later runs call starter_prefetch_start(manifest) first, a helper thread
+ * then reads the recorded ranges ahead while the path runs.
+ *
+ * The manifest keeps regular files only. Ranges of a file are merged over
+ * small holes and files are written in the order of their first block on
+ * disk (FIEMAP), so the helper's reads are few, large and mostly
+ * sequential.
+ */
+
+struct starter_prefetch_snapshot;
+
+struct starter_prefetch_snapshot *starter_prefetch_snapshot(void);
+
+void starter_prefetch_snapshot_free(struct starter_prefetch_snapshot *snap);
+
+/* before may be NULL, then every resident page is recorded */
+int starter_prefetch_record(const struct starter_prefetch_snapshot *before,
+			    const char *manifest);
+
+int starter_prefetch_start(const char *manifest);
+
+/* major faults of the process so far */
+long starter_prefetch_major_faults(void);
+
+#endif				/* __STARTER_PREFETCH_H__ */
@@ -28,18 +28,36 @@
 #include <vconf.h>
 #include <heynoti.h>
 #include <signal.h>
+#include <sys/signalfd.h>
 
 
 #include "starter.h"
 #include "x11.h"
+#include "noti.h"
+#include "prefetch.h"
 #include "lock-daemon.h"
 #include "lockd-debug.h"
+#include "lockd-metrics.h"
+#include "lockd-wakeup.h"
+#include "lockd-watchdog.h"
+#include "lockd-trace.h"
 
 #define DEFAULT_THEME "tizen"
 
 #define HIB_CAPTURING "/opt/etc/.hib_capturing"
 #define STR_STARTER_READY "/tmp/hibernation/starter_ready"
 
+/* pages the resume path touched, recorded by a training resume */
+#define RESUME_PREFETCH_MANIFEST "/opt/etc/.starter_resume_prefetch"
+#define RESUME_PREFETCH_TRAINING "/opt/etc/.starter_resume_training"
+
+/* the same for the boot, main to elm_run */
+#define BOOT_PREFETCH_MANIFEST "/opt/etc/.starter_boot_prefetch"
+#define BOOT_PREFETCH_TRAINING "/opt/etc/.starter_boot_training"
+
+/* hard limit for tearing down once power off has started */
+#define POWEROFF_BUDGET_MSEC 500
+
 static void lock_menu_screen(void)
 {
 	vconf_set_int(VCONFKEY_STARTER_SEQUENCE, 0);
@@ -61,14 +79,16 @@ static void _set_elm_theme(void)
 {
 	char *vstr;
 	char *theme;
-	Elm_Theme *th = NULL;
+	static Elm_Theme *th = NULL;
 	vstr = vconf_get_str(VCONFKEY_SETAPPL_WIDGET_THEME_STR);
 	if (vstr == NULL)
 		theme = DEFAULT_THEME;
 	else
 		theme = vstr;
 
-	th = elm_theme_new();
+	/* set again on hibernation leave, reuse the one theme */
+	if (th == NULL)
+		th = elm_theme_new();
 	_DBG("theme vconf[%s]\n set[%s]\n", vstr, theme);
 	elm_theme_set(th, theme);
 
@@ -78,15 +98,23 @@ static void _set_elm_theme(void)
 static int _launch_pwlock(void)
 {
 	int r;
+	uint64_t start_us;
 
 	_DBG("%s", __func__);
 
+	lockd_metrics_inc(LOCKD_CNT_PWLOCK_LAUNCH);
+	start_us = lockd_metrics_now();
+	STARTER_TRACE(pwlock_launch_begin);
 	r = aul_launch_app("org.tizen.pwlock", NULL);
+	STARTER_TRACE1(pwlock_launch_end, r);
+	lockd_metrics_observe_since(LOCKD_HIST_PWLOCK_LAUNCH, start_us);
 	if (r < 0) {
 		_ERR("PWLock launch error: error(%d)", r);
 		if (r == AUL_R_ETIMEOUT) {
 			_DBG("Launch pwlock is failed for AUL_R_ETIMEOUT, again launch pwlock");
+			STARTER_TRACE(pwlock_launch_begin);
 			r = aul_launch_app("org.tizen.pwlock", NULL);
+			STARTER_TRACE1(pwlock_launch_end, r);
 			if (r < 0) {
 				_ERR("2'nd PWLock launch error: error(%d)", r);
 				return -1;
@@ -107,22 +135,45 @@ static int _launch_pwlock(void)
 static void hib_leave(void *data)
 {
 	struct appdata *ad = data;
+	struct starter_prefetch_snapshot *snap = NULL;
+	long majflt;
+
 	if (ad == NULL) {
 		fprintf(stderr, "Invalid argument: appdata is NULL\n");
 		return;
 	}
 
+	STARTER_TRACE(hib_leave_begin);
+
+	/* first thing : read ahead what the last training resume touched */
+	if (access(RESUME_PREFETCH_TRAINING, F_OK) == 0)
+		snap = starter_prefetch_snapshot();
+	else
+		starter_prefetch_start(RESUME_PREFETCH_MANIFEST);
+	majflt = starter_prefetch_major_faults();
+
 	_DBG("%s", __func__);
+	lockd_metrics_inc(LOCKD_CNT_HIB_LEAVE);
 	_set_elm_theme();
 	start_lock_daemon();
 	if (_launch_pwlock() < 0) {
 		_ERR("launch pwlock error");
 	}
+
+	majflt = starter_prefetch_major_faults() - majflt;
+	lockd_metrics_add(LOCKD_CNT_RESUME_MAJFLT, majflt);
+	_DBG("hib_leave : %ld major faults", majflt);
+
+	if (snap != NULL) {
+		starter_prefetch_record(snap, RESUME_PREFETCH_MANIFEST);
+		starter_prefetch_snapshot_free(snap);
+	}
+
+	STARTER_TRACE(hib_leave_end);
 }
 
 static int add_noti(struct appdata *ad)
 {
-	int fd;
 	int r;
 	_DBG("%s %d\n", __func__, __LINE__);
 
@@ -131,72 +182,196 @@ static int add_noti(struct appdata *ad)
 		return -1;
 	}
 
-	fd = heynoti_init();
-	if (fd == -1) {
-		_ERR("Noti init error");
-		return -1;
-	}
-	ad->noti = fd;
-
-	r = heynoti_subscribe(fd, "HIBERNATION_PRELEAVE", hib_leave, ad);
+	r = starter_noti_subscribe("HIBERNATION_PRELEAVE", hib_leave, ad);
 	if (r == -1) {
 		_ERR("Noti subs error");
 		return -1;
 	}
 
-	r = heynoti_attach_handler(fd);
-	if (r == -1) {
-		_ERR("Noti attach error");
-		return -1;
-	}
-
 	_DBG("Waiting for hib leave");
 	_DBG("%s %d\n", __func__, __LINE__);
 
 	return 0;
 }
 
+static Eina_Bool _signal_cb(void *data, Ecore_Fd_Handler *fd_handler)
+{
+	struct signalfd_siginfo si;
+	int fd;
+
+	fd = ecore_main_fd_handler_fd_get(fd_handler);
+	lockd_wakeup_source("signalfd");
+
+	if (read(fd, &si, sizeof(si)) != sizeof(si))
+		return ECORE_CALLBACK_RENEW;
+
+	_DBG("_signal_cb : signal(%d) from pid(%d), Terminated...",
+	     si.ssi_signo, si.ssi_pid);
+	elm_exit();
+
+	return ECORE_CALLBACK_RENEW;
+}
+
+/*
+ * Without a signalfd : a handler that only does what is async signal safe,
+ * the main loop exits on its behalf.
+ */
+static volatile sig_atomic_t term_signal;
+static int term_pipe = -1;
+
 static void _signal_handler(int signum, siginfo_t *info, void *unused)
 {
-    _DBG("_signal_handler : Terminated...");
-    elm_exit();
+	int saved = errno;
+	char c = 0;
+
+	term_signal = signum;
+	if (term_pipe != -1 && write(term_pipe, &c, 1) < 0) {
+		/* full, one byte is enough */
+	}
+	errno = saved;
 }
-static void _heynoti_event_power_off(void *data)
+
+static Eina_Bool _signal_pipe_cb(void *data, Ecore_Fd_Handler *fd_handler)
 {
-    _DBG("_heynoti_event_power_off : Terminated...");
-    elm_exit();
+	char buf[16];
+
+	while (read(ecore_main_fd_handler_fd_get(fd_handler), buf,
+		    sizeof(buf)) > 0) ;
+
+	if (term_signal) {
+		_DBG("_signal_pipe_cb : signal(%d), Terminated...",
+		     (int)term_signal);
+		elm_exit();
+	}
+
+	return ECORE_CALLBACK_RENEW;
 }
 
-static int _init(struct appdata *ad)
+/* the signal interrupts the main loop's wait, this runs before the next */
+static Eina_Bool _signal_check_cb(void *data)
 {
-	int fd;
-	int r;
-	int fd1;
+	if (term_signal) {
+		_DBG("_signal_check_cb : signal(%d), Terminated...",
+		     (int)term_signal);
+		elm_exit();
+	}
+
+	return ECORE_CALLBACK_RENEW;
+}
 
+static void _init_signal_handler(struct appdata *ad, sigset_t *mask)
+{
 	struct sigaction act;
+	int fds[2];
+
+	if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) == 0) {
+		ad->sig_handler = ecore_main_fd_handler_add(fds[0],
+							    ECORE_FD_READ,
+							    _signal_pipe_cb,
+							    ad, NULL, NULL);
+		if (ad->sig_handler != NULL) {
+			ad->sigfd = fds[0];
+			term_pipe = fds[1];
+		} else {
+			close(fds[0]);
+			close(fds[1]);
+		}
+	}
+	if (ad->sig_handler == NULL)
+		ad->sig_check = ecore_idle_enterer_add(_signal_check_cb, ad);
+
+	memset(&act, 0, sizeof(act));
 	act.sa_sigaction = _signal_handler;
-	act.sa_flags = SA_SIGINFO;
+	act.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigemptyset(&act.sa_mask);
+	if (sigaction(SIGTERM, &act, NULL) < 0)
+		_ERR("Failed to sigaction[%s]", strerror(errno));
 
-	int ret = sigemptyset(&act.sa_mask);
-	if (ret < 0) {
-		_ERR("Failed to sigemptyset[%s]", strerror(errno));
+	sigprocmask(SIG_UNBLOCK, mask, NULL);
+}
+
+static void _heynoti_event_power_off(void *data)
+{
+	struct appdata *ad = data;
+	struct itimerval budget;
+
+	_DBG("_heynoti_event_power_off : Terminated...");
+
+	if (ad != NULL) {
+		ad->fast_exit = 1;
+		gettimeofday(&ad->tv_exit, NULL);
 	}
-	ret = sigaddset(&act.sa_mask, SIGTERM);
-	if (ret < 0) {
-		_ERR("Failed to sigaddset[%s]", strerror(errno));
+
+	/* SIGALRM keeps its default action, a stuck teardown gets killed */
+	memset(&budget, 0, sizeof(budget));
+	budget.it_value.tv_sec = POWEROFF_BUDGET_MSEC / 1000;
+	budget.it_value.tv_usec = (POWEROFF_BUDGET_MSEC % 1000) * 1000;
+	signal(SIGALRM, SIG_DFL);
+	setitimer(ITIMER_REAL, &budget, NULL);
+
+	elm_exit();
+}
+
+static void _block_signals(void)
+{
+	sigset_t mask;
+
+	/* block before any thread is created so that every thread inherits it
+	 * and SIGTERM is only ever delivered through the signalfd */
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGTERM);
+	if (sigprocmask(SIG_BLOCK, &mask, NULL) < 0) {
+		_ERR("Failed to sigprocmask[%s]", strerror(errno));
 	}
-	ret = sigaction(SIGTERM, &act, NULL);
-	if (ret < 0) {
-		_ERR("Failed to sigaction[%s]", strerror(errno));
+}
+
+static int _init_signal(struct appdata *ad)
+{
+	sigset_t mask;
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGTERM);
+
+	ad->sigfd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+	if (ad->sigfd < 0) {
+		_ERR("Failed to signalfd[%s]", strerror(errno));
+		_init_signal_handler(ad, &mask);
+		return -1;
+	}
+
+	ad->sig_handler = ecore_main_fd_handler_add(ad->sigfd, ECORE_FD_READ,
+						    _signal_cb, ad, NULL, NULL);
+	if (ad->sig_handler == NULL) {
+		_ERR("Failed to add signal fd handler");
+		close(ad->sigfd);
+		ad->sigfd = -1;
+		_init_signal_handler(ad, &mask);
+		return -1;
 	}
 
+	return 0;
+}
+
+static int _init(struct appdata *ad)
+{
+	int fd;
+	int r;
+	int fd1;
+	struct timeval tv, res;
+
 	memset(ad, 0, sizeof(struct appdata));
 
-	ad->noti = -1;
+	ad->sigfd = -1;
 	gettimeofday(&ad->tv_start, NULL);
+	STARTER_TRACE(init_begin);
+
+	lockd_wakeup_init();
+	lockd_watchdog_init();
+	_init_signal(ad);
 
 	lock_menu_screen();
 	_set_elm_theme();
+	STARTER_TRACE(init_theme_set);
 
 	_DBG("%s %d\n", __func__, __LINE__);
 
@@ -213,6 +388,7 @@ static int _init(struct appdata *ad)
 		close(fd);
 		r = add_noti(ad);
 	}
+	STARTER_TRACE(init_lock_daemon);
 
 	fd1 = open(STR_STARTER_READY, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
 	if (fd1 > 0) {
@@ -220,6 +396,12 @@ static int _init(struct appdata *ad)
 		close(fd1);
 	}
 
+	gettimeofday(&tv, NULL);
+	timersub(&tv, &ad->tv_start, &res);
+	lockd_metrics_observe(LOCKD_HIST_BOOT_INIT,
+			      (uint64_t)res.tv_sec * 1000000 + res.tv_usec);
+	STARTER_TRACE(init_end);
+
 	return r;
 }
 
@@ -231,8 +413,28 @@ static void _fini(struct appdata *ad)
 		fprintf(stderr, "Invalid argument: appdata is NULL\n");
 		return;
 	}
-	if (ad->noti != -1)
-		heynoti_close(ad->noti);
+	stop_lock_daemon();
+	starter_noti_fini();
+
+	if (ad->sig_handler != NULL) {
+		ecore_main_fd_handler_del(ad->sig_handler);
+		ad->sig_handler = NULL;
+	}
+	/* before the read end : a write to a pipe without one is a SIGPIPE */
+	if (term_pipe != -1) {
+		int fd = term_pipe;
+
+		term_pipe = -1;
+		close(fd);
+	}
+	if (ad->sigfd != -1) {
+		close(ad->sigfd);
+		ad->sigfd = -1;
+	}
+	if (ad->sig_check != NULL) {
+		ecore_idle_enterer_del(ad->sig_check);
+		ad->sig_check = NULL;
+	}
 
 	unlock_menu_screen();
 
@@ -241,30 +443,64 @@ static void _fini(struct appdata *ad)
 	_DBG("Total time: %d.%06d sec\n", (int)res.tv_sec, (int)res.tv_usec);
 }
 
+/* power off: nothing we would tear down outlives the reboot anyway */
+static void _fini_fast(struct appdata *ad)
+{
+	struct timeval tv, res;
+
+	gettimeofday(&tv, NULL);
+	timersub(&tv, &ad->tv_exit, &res);
+	lockd_metrics_observe(LOCKD_HIST_SHUTDOWN,
+			      (uint64_t)res.tv_sec * 1000000 + res.tv_usec);
+	_DBG("Power off teardown: %d.%06d sec\n", (int)res.tv_sec,
+	     (int)res.tv_usec);
+}
+
 int main(int argc, char *argv[])
 {
 	struct appdata ad;
-
-	int heyfd = heynoti_init();
-	if (heyfd < 0) {
-		_ERR("Failed to heynoti_init[%d]", heyfd);
+	int prefetch_training;
+
+	/* before the read ahead thread, it has to inherit the signal mask */
+	lockd_metrics_init();
+	_block_signals();
+
+	/*
+	 * then read ahead the libraries and theme files the last training
+	 * boot touched, while storage is busy with everybody else
+	 */
+	prefetch_training = access(BOOT_PREFETCH_TRAINING, F_OK) == 0;
+	if (!prefetch_training)
+		starter_prefetch_start(BOOT_PREFETCH_MANIFEST);
+
+	if (starter_noti_init() < 0) {
+		_ERR("Failed to init noti");
 	}
 
-	int ret = heynoti_subscribe(heyfd, "power_off_start", _heynoti_event_power_off, NULL);
-	if (ret < 0) {
-		_ERR("Failed to heynoti_subscribe[%d]", ret);
-	}
-	ret = heynoti_attach_handler(heyfd);
+	int ret = starter_noti_subscribe("power_off_start", _heynoti_event_power_off, &ad);
 	if (ret < 0) {
-		_ERR("Failed to heynoti_attach_handler[%d]", ret);
+		_ERR("Failed to subscribe power_off_start[%d]", ret);
 	}
+	lock_daemon_set_noti_subscriber(starter_noti_subscribe,
+					starter_noti_unsubscribe);
 
 	elm_init(argc, argv);
 
 	_init(&ad);
 
+	/* the dynamic loader's faults before main count as well */
+	lockd_metrics_add(LOCKD_CNT_BOOT_MAJFLT,
+			  starter_prefetch_major_faults());
+	if (prefetch_training)
+		starter_prefetch_record(NULL, BOOT_PREFETCH_MANIFEST);
+
 	elm_run();
 
+	if (ad.fast_exit) {
+		_fini_fast(&ad);
+		_exit(0);
+	}
+
 	_fini(&ad);
 
 	elm_shutdown();
@@ -18,10 +18,19 @@
 #define __STARTER_H__
 
 #include <sys/time.h>
+#include <Ecore.h>
 
 struct appdata {
 	struct timeval tv_start;
-	int noti;
+
+	/* a signalfd, or the read end of the signal handler's pipe */
+	int sigfd;
+	Ecore_Fd_Handler *sig_handler;
+	/* without either, the handler's flag is looked at here */
+	Ecore_Idle_Enterer *sig_check;
+
+	int fast_exit;
+	struct timeval tv_exit;
 };
 
 #endif				/* __STARTER_H__ */
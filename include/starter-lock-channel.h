@@ -0,0 +1,106 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __STARTER_LOCK_CHANNEL_H__
+#define __STARTER_LOCK_CHANNEL_H__
+
+/*
+ * Relock channel between the lock daemon and a resident lock app.
+ *
+ * When LCD goes off and the lock app is still running, the daemon used to
+ * relaunch it through aul just to bring it back to its locked state. A lock
+ * app that connects here gets a one byte STARTER_LOCK_CHANNEL_RELOCK message
+ * instead. Apps that do not connect keep getting the aul reset.
+ *
+ *	int fd = starter_lock_channel_connect();
+ *	...add fd to the main loop, when it is readable :
+ *	switch (starter_lock_channel_read(fd)) {
+ *	case STARTER_LOCK_CHANNEL_RELOCK:
+ *		...back to the locked state...
+ *		break;
+ *	case -1:
+ *		...starter went away, close fd and connect again later...
+ *	}
+ *
+ * The daemon knows the app by the pid of the connecting process, so the
+ * lock app itself must connect. The socket is SOCK_SEQPACKET in the
+ * abstract namespace.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define STARTER_LOCK_CHANNEL_NAME	"starter-lock-channel"
+
+/* lock app -> starter, once after connecting */
+#define STARTER_LOCK_CHANNEL_HELLO	'H'
+/* starter -> lock app */
+#define STARTER_LOCK_CHANNEL_RELOCK	'R'
+
+static inline socklen_t starter_lock_channel_addr(struct sockaddr_un *addr)
+{
+	memset(addr, 0, sizeof(struct sockaddr_un));
+	addr->sun_family = AF_UNIX;
+	/* abstract : sun_path starts with a nul byte */
+	memcpy(addr->sun_path + 1, STARTER_LOCK_CHANNEL_NAME,
+	       sizeof(STARTER_LOCK_CHANNEL_NAME) - 1);
+
+	return offsetof(struct sockaddr_un, sun_path) + 1
+	    + sizeof(STARTER_LOCK_CHANNEL_NAME) - 1;
+}
+
+/* returns a non blocking fd, or -1 if starter does not listen */
+static inline int starter_lock_channel_connect(void)
+{
+	struct sockaddr_un addr;
+	socklen_t len;
+	char hello = STARTER_LOCK_CHANNEL_HELLO;
+	int fd;
+
+	fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return -1;
+
+	len = starter_lock_channel_addr(&addr);
+	if (connect(fd, (struct sockaddr *)&addr, len) < 0
+	    || send(fd, &hello, 1, MSG_NOSIGNAL) != 1) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+/* the message, 0 if there is none yet, -1 once the channel is closed */
+static inline int starter_lock_channel_read(int fd)
+{
+	char msg;
+	ssize_t n;
+
+	n = recv(fd, &msg, 1, MSG_DONTWAIT);
+	if (n == 1)
+		return (unsigned char)msg;
+	if (n < 0 && (errno == EAGAIN || errno == EINTR))
+		return 0;
+
+	return -1;
+}
+
+#endif				/* __STARTER_LOCK_CHANNEL_H__ */
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __STARTER_LOCK_CONTROL_H__
+#define __STARTER_LOCK_CONTROL_H__
+
+/*
+ * Lock control socket : lock now, unlock, the lock state and its changes
+ * in one local message instead of a VCONFKEY_IDLE_LOCK_STATE write and the
+ * notification round trip.
+ *
+ *	struct starter_lock_control_msg reply;
+ *	int fd = starter_lock_control_connect();
+ *
+ *	if (fd >= 0
+ *	    && starter_lock_control_request(fd, STARTER_LOCK_CONTROL_LOCK,
+ *					    &reply) == 0 && reply.error == 0)
+ *		...the lock screen is on its way...
+ *
+ * Every message, both ways, is one struct starter_lock_control_msg on a
+ * SOCK_SEQPACKET socket in the abstract namespace. Each request gets one
+ * reply of the same type carrying the lock state at that time. After
+ * STARTER_LOCK_CONTROL_SUBSCRIBE the connection also gets a
+ * STARTER_LOCK_CONTROL_EVENT for each lock state change; a subscriber that
+ * does not keep up is disconnected rather than sent stale states.
+ *
+ * Who may do what is checked with the peer's credentials : lock by root
+ * and apps (uid 5000, the owner of VCONFKEY_IDLE_LOCK_STATE), unlock by
+ * root and the running lock app only, state and subscribe by anyone.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#define STARTER_LOCK_CONTROL_NAME	"starter-lock-control"
+/* how long a request waits for its reply */
+#define STARTER_LOCK_CONTROL_TIMEOUT_SEC	3
+
+/* client -> starter */
+#define STARTER_LOCK_CONTROL_LOCK	'L'
+#define STARTER_LOCK_CONTROL_UNLOCK	'U'
+#define STARTER_LOCK_CONTROL_STATUS	'S'
+#define STARTER_LOCK_CONTROL_SUBSCRIBE	'W'
+/* starter -> subscriber */
+#define STARTER_LOCK_CONTROL_EVENT	'E'
+
+struct starter_lock_control_msg {
+	uint8_t type;
+	uint8_t reserved;
+	int16_t error;		/* replies : 0 or a negative errno */
+	int32_t state;		/* VCONFKEY_IDLE_LOCK or VCONFKEY_IDLE_UNLOCK */
+	int32_t pid;		/* the lock app, 0 if there is none */
+};
+
+static inline socklen_t starter_lock_control_addr(struct sockaddr_un *addr)
+{
+	memset(addr, 0, sizeof(struct sockaddr_un));
+	addr->sun_family = AF_UNIX;
+	/* abstract : sun_path starts with a nul byte */
+	memcpy(addr->sun_path + 1, STARTER_LOCK_CONTROL_NAME,
+	       sizeof(STARTER_LOCK_CONTROL_NAME) - 1);
+
+	return offsetof(struct sockaddr_un, sun_path) + 1
+	    + sizeof(STARTER_LOCK_CONTROL_NAME) - 1;
+}
+
+/* returns a blocking fd, or -1 if starter does not listen */
+static inline int starter_lock_control_connect(void)
+{
+	struct sockaddr_un addr;
+	socklen_t len;
+	int fd;
+
+	fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		return -1;
+
+	len = starter_lock_control_addr(&addr);
+	if (connect(fd, (struct sockaddr *)&addr, len) < 0) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+static inline int starter_lock_control_send(int fd, int type)
+{
+	struct starter_lock_control_msg msg;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.type = type;
+	if (send(fd, &msg, sizeof(msg), MSG_NOSIGNAL) != sizeof(msg))
+		return -1;
+
+	return 0;
+}
+
+/* 1 with a message, 0 if there is none yet (non blocking fd), -1 once closed */
+static inline int starter_lock_control_recv(int fd,
+					    struct starter_lock_control_msg *msg)
+{
+	ssize_t n;
+
+	n = recv(fd, msg, sizeof(struct starter_lock_control_msg), 0);
+	if (n == sizeof(struct starter_lock_control_msg))
+		return 1;
+	if (n < 0 && (errno == EAGAIN || errno == EINTR))
+		return 0;
+
+	return -1;
+}
+
+/*
+ * A request and its reply, on a blocking fd. Events that come in between
+ * are skipped, subscribe on a connection of its own to see them all.
+ * Sets SO_RCVTIMEO on fd : -1 with errno ETIMEDOUT if starter does not
+ * answer within STARTER_LOCK_CONTROL_TIMEOUT_SEC.
+ */
+static inline int starter_lock_control_request(int fd, int type,
+					       struct starter_lock_control_msg
+					       *reply)
+{
+	struct timeval tv = { STARTER_LOCK_CONTROL_TIMEOUT_SEC, 0 };
+	ssize_t n;
+
+	if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0)
+		return -1;
+	if (starter_lock_control_send(fd, type) < 0)
+		return -1;
+
+	for (;;) {
+		n = recv(fd, reply, sizeof(struct starter_lock_control_msg), 0);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			errno = ETIMEDOUT;
+			return -1;
+		}
+		if (n != sizeof(struct starter_lock_control_msg))
+			return -1;
+		if (reply->type == type)
+			return 0;
+	}
+}
+
+#endif				/* __STARTER_LOCK_CONTROL_H__ */
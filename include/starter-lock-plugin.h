@@ -0,0 +1,64 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __STARTER_LOCK_PLUGIN_H__
+#define __STARTER_LOCK_PLUGIN_H__
+
+/*
+ * In-process lock screen plugin.
+ *
+ * A lock screen package may ship STARTER_LOCK_PLUGIN_DIR/<pkgname>.so. When
+ * the configured lock screen package has one, the lock daemon loads it into
+ * starter and drives it from starter's Elementary main loop instead of
+ * launching the package as a separate process. Without a plugin, or if the
+ * plugin fails, the package is launched as an app as before.
+ *
+ * The plugin exports one symbol :
+ *
+ *	const struct starter_lock_plugin starter_lock_plugin = {
+ *		.abi_version = STARTER_LOCK_PLUGIN_ABI_VERSION,
+ *		.create = ..., .show = ..., .hide = ..., .destroy = ...,
+ *	};
+ *
+ * All entry points are called on starter's main thread.
+ */
+
+#define STARTER_LOCK_PLUGIN_DIR		"/usr/lib/starter/lock-plugins"
+#define STARTER_LOCK_PLUGIN_SYMBOL	"starter_lock_plugin"
+#define STARTER_LOCK_PLUGIN_ABI_VERSION	1
+
+struct starter_lock_plugin_host {
+	/* call when the user has unlocked, the plugin is hidden in return */
+	void (*unlock) (void *data);
+	void *data;
+};
+
+struct starter_lock_plugin {
+	int abi_version;
+
+	/* build the lock UI for the given X screen, keep it hidden */
+	void *(*create) (const struct starter_lock_plugin_host * host,
+			 int screen);
+
+	/* show the lock UI, returns its top level X window or 0 on failure */
+	unsigned int (*show) (void *priv);
+
+	void (*hide) (void *priv);
+
+	void (*destroy) (void *priv);
+};
+
+#endif				/* __STARTER_LOCK_PLUGIN_H__ */
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __STARTER_LOCKSTATE_H__
+#define __STARTER_LOCKSTATE_H__
+
+/*
+ * Lock state published by the lock daemon in a read-only shared memory
+ * segment. VCONFKEY_IDLE_LOCK_STATE stays the compatibility path; this is
+ * for readers that poll and cannot afford a vconf round trip.
+ *
+ *	struct starter_lockstate *ls = starter_lockstate_open();
+ *	struct starter_lockstate_snapshot snap;
+ *
+ *	if (ls && starter_lockstate_read(ls, &snap) == 0 && snap.state)
+ *		...locked...
+ *	starter_lockstate_close(ls);
+ *
+ * The segment is protected by a sequence lock: the writer makes seq odd
+ * while it updates the record, readers retry until they see the same even
+ * seq before and after copying it.
+ */
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define STARTER_LOCKSTATE_SHM_NAME	"/starter-lockstate"
+#define STARTER_LOCKSTATE_MAGIC		0x4c4b5354
+#define STARTER_LOCKSTATE_VERSION	1
+
+struct starter_lockstate {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t seq;
+	int32_t state;		/* VCONFKEY_IDLE_LOCK or VCONFKEY_IDLE_UNLOCK */
+	int32_t lock_app_pid;
+	int32_t reserved;
+	uint64_t last_lock_ns;	/* CLOCK_MONOTONIC */
+	uint64_t last_unlock_ns;	/* CLOCK_MONOTONIC */
+};
+
+struct starter_lockstate_snapshot {
+	int state;
+	int lock_app_pid;
+	uint64_t last_lock_ns;
+	uint64_t last_unlock_ns;
+};
+
+static inline struct starter_lockstate *starter_lockstate_open(void)
+{
+	struct starter_lockstate *ls;
+	int fd;
+
+	fd = shm_open(STARTER_LOCKSTATE_SHM_NAME, O_RDONLY, 0);
+	if (fd < 0)
+		return NULL;
+
+	ls = (struct starter_lockstate *)mmap(NULL,
+					      sizeof(struct starter_lockstate),
+					      PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (ls == MAP_FAILED)
+		return NULL;
+
+	if (ls->magic != STARTER_LOCKSTATE_MAGIC
+	    || ls->version != STARTER_LOCKSTATE_VERSION) {
+		munmap(ls, sizeof(struct starter_lockstate));
+		return NULL;
+	}
+
+	return ls;
+}
+
+static inline void starter_lockstate_close(struct starter_lockstate *ls)
+{
+	if (ls)
+		munmap(ls, sizeof(struct starter_lockstate));
+}
+
+/* returns 0 on success, -1 if no consistent copy was seen */
+static inline int starter_lockstate_read(const struct starter_lockstate *ls,
+					 struct starter_lockstate_snapshot *snap)
+{
+	const volatile struct starter_lockstate *v = ls;
+	uint32_t seq;
+	int retry;
+
+	for (retry = 0; retry < 1000; retry++) {
+		seq = v->seq;
+		if (seq & 1)
+			continue;
+		__sync_synchronize();
+
+		snap->state = v->state;
+		snap->lock_app_pid = v->lock_app_pid;
+		snap->last_lock_ns = v->last_lock_ns;
+		snap->last_unlock_ns = v->last_unlock_ns;
+
+		__sync_synchronize();
+		if (v->seq == seq)
+			return 0;
+	}
+
+	return -1;
+}
+
+#endif				/* __STARTER_LOCKSTATE_H__ */
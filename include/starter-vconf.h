@@ -24,4 +24,18 @@
 
 #define VCONF_PRIVATE_LOCKSCREEN_PKGNAME "file/private/lockscreen/pkgname"
 
+/*
+ * Start the lock app hidden on LCD dim, for lock apps that handle the
+ * "prepare" mode. 0 is off, otherwise the number of dims in a row that may
+ * end without LCD off before the hidden app is terminated.
+ */
+#define VCONF_PRIVATE_LOCKSCREEN_SPECULATIVE "file/private/lockscreen/speculative"
+
+/*
+ * Started by three presses of the home key while locked, empty for none.
+ * It has to be able to show over the lock screen. Owned by root : whoever
+ * can write it picks what runs over the lock screen.
+ */
+#define VCONF_PRIVATE_LOCKSCREEN_EMERGENCY "file/private/lockscreen/emergency_pkgname"
+
 #endif				/* __STARTER_VCONF_H__ */
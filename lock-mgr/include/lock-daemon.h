@@ -17,6 +17,23 @@
 #ifndef __LOCK_DAEMON_H__
 #define __LOCK_DAEMON_H__
 
+/*
+ * liblock-daemon may be built with -fvisibility=hidden, what starter and the
+ * tools call is marked like this and listed in lock-mgr/lock-daemon.map
+ */
+#pragma GCC visibility push(default)
+
+typedef int (*lock_daemon_noti_subscriber) (const char *event,
+					    void (*cb) (void *), void *data);
+
+/* lets the lock daemon share the owner's heynoti channel */
+void lock_daemon_set_noti_subscriber(lock_daemon_noti_subscriber subscribe,
+				     lock_daemon_noti_subscriber unsubscribe);
+
 int start_lock_daemon();
 
+void stop_lock_daemon(void);
+
+#pragma GCC visibility pop
+
 #endif				/* __LOCK_DAEMON_H__ */
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LOCKD_BOOST_H__
+#define __LOCKD_BOOST_H__
+
+/*
+ * Resources of the lock app. From its launch until its window is matched
+ * it runs with a higher CPU and IO priority, then gets its own back. While
+ * it is the lock screen its oom_score_adj keeps the OOM killer away from it,
+ * so that the next LCD off still finds it resident.
+ *
+ * Launches may come from the lock fast path thread, the rest is main loop.
+ * STARTER_LOCK_BOOST=0 leaves priorities alone, to compare lock latencies.
+ */
+
+void lockd_boost_init(void);
+
+void lockd_boost_start(int pid);
+
+/* back to the app's own priorities, nothing if it was not boosted */
+void lockd_boost_end(int pid);
+
+void lockd_boost_protect(int pid);
+
+void lockd_boost_unprotect(int pid);
+
+#endif				/* __LOCKD_BOOST_H__ */
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LOCKD_CHANNEL_H__
+#define __LOCKD_CHANNEL_H__
+
+/*
+ * Daemon side of the relock channel (starter-lock-channel.h). Connections
+ * are accepted on the main loop, lockd_channel_relock() may be called from
+ * any thread.
+ */
+
+int lockd_channel_init(void);
+
+/* 0 if the relock was sent to the lock app with this pid */
+int lockd_channel_relock(int pid);
+
+void lockd_channel_fini(void);
+
+#endif				/* __LOCKD_CHANNEL_H__ */
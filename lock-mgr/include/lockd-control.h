@@ -0,0 +1,43 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LOCKD_CONTROL_H__
+#define __LOCKD_CONTROL_H__
+
+/*
+ * Daemon side of the lock control socket (starter-lock-control.h). Served
+ * from the main loop, every call here must be made from it too.
+ *
+ * The requests go to ops, which return 0 or a negative errno for the
+ * reply. Credentials are checked before : lock needs root or the app uid,
+ * unlock gets the peer's uid and pid to decide.
+ */
+
+struct lockd_control_ops {
+	int (*lock) (void *data);
+	int (*unlock) (int uid, int pid, void *data);
+	/* the lock state, and the lock app's pid in *pid */
+	int (*state) (int *pid, void *data);
+};
+
+int lockd_control_init(const struct lockd_control_ops *ops, void *data);
+
+/* tells the subscribers */
+void lockd_control_event(int state, int pid);
+
+void lockd_control_fini(void);
+
+#endif				/* __LOCKD_CONTROL_H__ */
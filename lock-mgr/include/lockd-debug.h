@@ -28,7 +28,9 @@
 
 #define ENABLE_LOG_SYSTEM
 
+#pragma GCC visibility push(default)
 void lockd_log_t(char *fmt, ...);
+#pragma GCC visibility pop
 
 #ifdef ENABLE_LOG_SYSTEM
 #define STARTER_ERR(fmt, arg...)  LOGE("["LOG_TAG"%s:%d:E] "fmt, __FILE__, __LINE__, ##arg)
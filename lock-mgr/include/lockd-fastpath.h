@@ -0,0 +1,48 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LOCKD_FASTPATH_H__
+#define __LOCKD_FASTPATH_H__
+
+/*
+ * Lock fast path : a thread with raised priority that sees PM state changes,
+ * LCD off above all, and runs state_cb without waiting for the main loop.
+ *
+ * It watches the vconf memory backend file of VCONFKEY_PM_STATE itself, so a
+ * busy main loop does not delay it. The PM state the main loop's vconf
+ * callback sees is passed on with lockd_fastpath_pm_state() as well, in case
+ * the file cannot be watched. state_cb runs once per transition, whichever
+ * source reported it first.
+ *
+ * Disabled with STARTER_LOCK_FASTPATH=0. STARTER_PM_STATE_FILE replaces
+ * the watched file.
+ */
+
+int lockd_fastpath_start(void (*state_cb) (int, void *), void *data);
+
+#pragma GCC visibility push(default)
+int lockd_fastpath_enabled(void);
+#pragma GCC visibility pop
+
+/* main loop side, the PM state from the vconf notification */
+void lockd_fastpath_pm_state(int val);
+
+/* a lock asked for without LCD off (lockd-control.h), state_cb gets LCDOFF */
+int lockd_fastpath_lock_now(void);
+
+void lockd_fastpath_stop(void);
+
+#endif				/* __LOCKD_FASTPATH_H__ */
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LOCKD_JOURNAL_H__
+#define __LOCKD_JOURNAL_H__
+
+#include <stdint.h>
+
+/*
+ * Event journal. With STARTER_JOURNAL=<file> in the environment the lock
+ * daemon appends every input it reacts to, and the results of the calls
+ * whose outcome depends on the rest of the system, to <file>.
+ * starter-replay feeds such a journal back into the daemon.
+ */
+
+#define LOCKD_JOURNAL_MAGIC	0x4a444b4c
+#define LOCKD_JOURNAL_VERSION	1
+
+enum lockd_journal_type {
+	/* inputs */
+	LOCKD_JOURNAL_PM_STATE = 1,	/* arg0 : pm state */
+	LOCKD_JOURNAL_LOCK_STATE,	/* arg0 : idle lock state */
+	LOCKD_JOURNAL_APP_DEAD,		/* arg0 : pid */
+	LOCKD_JOURNAL_WIN_CREATE,	/* arg0 : window, arg1 : pid */
+	LOCKD_JOURNAL_WIN_SHOW,		/* arg0 : window, arg1 : pid */
+	LOCKD_JOURNAL_NOTI,		/* arg0 : lockd_journal_noti */
+	LOCKD_JOURNAL_CONTROL,		/* arg0 : lock control request, allowed */
+	LOCKD_JOURNAL_KEY,		/* arg0 : lockd_key_action, arg1 : slot */
+	LOCKD_JOURNAL_WIN_DAMAGE,	/* arg0 : damaged window */
+
+	/* results of calls to the rest of the system */
+	LOCKD_JOURNAL_LAUNCH = 64,	/* arg0 : pid or error */
+	LOCKD_JOURNAL_CHECK_LOCK,	/* arg0 : pid, arg1 : running */
+	LOCKD_JOURNAL_CALL_STATE,	/* arg0 : call state */
+
+	/* what the daemon did */
+	LOCKD_JOURNAL_SET_LOCK_STATE = 128,	/* arg0 : idle lock state */
+};
+
+enum lockd_journal_noti {
+	LOCKD_JOURNAL_NOTI_POWER_OFF = 1,
+};
+
+struct lockd_journal_header {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t start_ns;
+};
+
+struct lockd_journal_record {
+	uint64_t ts_ns;		/* CLOCK_MONOTONIC, relative to start_ns */
+	uint32_t type;
+	int32_t arg[3];
+};
+
+int lockd_journal_init(void);
+
+int lockd_journal_enabled(void);
+
+void lockd_journal_record(enum lockd_journal_type type, int arg0, int arg1);
+
+#endif				/* __LOCKD_JOURNAL_H__ */
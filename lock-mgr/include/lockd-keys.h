@@ -0,0 +1,55 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LOCKD_KEYS_H__
+#define __LOCKD_KEYS_H__
+
+/*
+ * Keys starter acts on while a screen is locked. Only the keys of the table
+ * in lockd-keys.c are grabbed, on the input window of each locked screen,
+ * and only from lock to unlock : grab and ungrab do nothing when the window
+ * already is in that state. Every call here is made from the main loop.
+ */
+
+enum lockd_key_action {
+	/* bring the lock app back over whatever was shown on top of it */
+	LOCKD_KEY_WAKE = 1,
+	/* the emergency call app configured in VCONF_PRIVATE_LOCKSCREEN_EMERGENCY */
+	LOCKD_KEY_EMERGENCY,
+};
+
+/* data is what the window was grabbed with */
+typedef void (*lockd_key_action_cb) (enum lockd_key_action action,
+				     void *data);
+
+void lockd_keys_init(lockd_key_action_cb cb);
+
+/* win is a screen's lockd_window_mgr_get_input_window() */
+void lockd_keys_grab(unsigned int win, void *data);
+
+void lockd_keys_ungrab(unsigned int win);
+
+/*
+ * Runs the action as a key press would, n is the window's slot as the
+ * journal records it. For starter-replay.
+ */
+#pragma GCC visibility push(default)
+void lockd_keys_action(int n, enum lockd_key_action action);
+#pragma GCC visibility pop
+
+void lockd_keys_fini(void);
+
+#endif				/* __LOCKD_KEYS_H__ */
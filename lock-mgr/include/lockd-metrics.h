@@ -0,0 +1,128 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LOCKD_METRICS_H__
+#define __LOCKD_METRICS_H__
+
+#include <stdint.h>
+
+/*
+ * The metrics page is a POSIX shared memory object. starter updates it in
+ * place with atomic operations, and readers (starter-metrics) only mmap it
+ * read-only, so nothing on the hot path allocates or does I/O.
+ */
+#define LOCKD_METRICS_SHM_NAME		"/starter-metrics"
+#define LOCKD_METRICS_MAGIC		0x4d545253
+#define LOCKD_METRICS_VERSION		1
+
+#define LOCKD_METRICS_NAME_MAX		32
+#define LOCKD_METRICS_HIST_BUCKETS	20
+/* bucket i holds values below (LOCKD_METRICS_BUCKET_BASE_US << i) usec,
+ * the last bucket holds everything above */
+#define LOCKD_METRICS_BUCKET_BASE_US	64
+
+enum lockd_metrics_counter_id {
+	LOCKD_CNT_LOCK = 0,
+	LOCKD_CNT_UNLOCK,
+	LOCKD_CNT_LAUNCH,
+	LOCKD_CNT_LAUNCH_RETRY,
+	LOCKD_CNT_LAUNCH_DEFAULT,
+	LOCKD_CNT_LAUNCH_FAIL,
+	LOCKD_CNT_RESTART,
+	LOCKD_CNT_APP_DEAD,
+	LOCKD_CNT_WIN_MATCH,
+	LOCKD_CNT_PWLOCK_LAUNCH,
+	LOCKD_CNT_HIB_LEAVE,
+	LOCKD_CNT_PLACEHOLDER,
+	LOCKD_CNT_PLUGIN_LOCK,
+	LOCKD_CNT_RESUME_MAJFLT,	/* major faults during hib_leave */
+	LOCKD_CNT_RELOCK_CHANNEL,	/* restarts done over the relock channel */
+	LOCKD_CNT_LOOP_STALL,		/* main loop iterations over the watchdog threshold */
+	LOCKD_CNT_SPEC_LAUNCH,		/* lock apps started hidden on LCD dim */
+	LOCKD_CNT_SPEC_HIT,		/* LCD off that only had to show one */
+	LOCKD_CNT_SPEC_CANCEL,		/* ones terminated after too many wasted dims */
+	LOCKD_CNT_LOCK_ADOPT,		/* lock apps taken back from the last daemon */
+	LOCKD_CNT_BOOT_MAJFLT,		/* major faults from exec to elm_run */
+	LOCKD_CNT_CONTROL,		/* lock control socket requests */
+	LOCKD_CNT_KEY,			/* key presses delivered while locked */
+	LOCKD_CNT_KEY_GRAB,		/* utilx key grab and ungrab calls */
+	LOCKD_CNT_SUSPEND_BLOCK,	/* suspend blocked from LCD off */
+	LOCKD_CNT_SUSPEND_TIMEOUT,	/* ... and dropped without the lock window */
+	LOCKD_CNT_VISIBLE_NO_DAMAGE,	/* lock visible taken at the match, no DAMAGE */
+	LOCKD_CNT_MAX,
+};
+
+enum lockd_metrics_hist_id {
+	LOCKD_HIST_LOCK_LATENCY = 0,	/* LCD off -> lock window matched */
+	LOCKD_HIST_LAUNCH,		/* one aul_launch_app call */
+	LOCKD_HIST_WIN_MATCH,		/* lockd_window_set_window_property */
+	LOCKD_HIST_PWLOCK_LAUNCH,	/* _launch_pwlock */
+	LOCKD_HIST_BOOT_INIT,		/* starter _init */
+	LOCKD_HIST_SHUTDOWN,		/* power off notification -> exit */
+	LOCKD_HIST_PLACEHOLDER,		/* LCD off -> placeholder mapped */
+	LOCKD_HIST_LCDOFF_LAUNCH,	/* LCD off -> lock app launch issued */
+	LOCKD_HIST_LOOP_ITER,		/* one main loop iteration, with the watchdog */
+	LOCKD_HIST_BOOSTED,		/* lock app launch -> window matched, boosted */
+	LOCKD_HIST_SUSPEND_BLOCK,	/* suspend blocked -> released */
+	LOCKD_HIST_LOCK_VISIBLE,	/* LCD off -> first paint of the lock window */
+	LOCKD_HIST_MAX,
+};
+
+struct lockd_metrics_counter {
+	char name[LOCKD_METRICS_NAME_MAX];
+	uint64_t value;
+};
+
+struct lockd_metrics_hist {
+	char name[LOCKD_METRICS_NAME_MAX];
+	uint64_t count;
+	uint64_t sum_us;
+	uint64_t max_us;
+	uint64_t bucket[LOCKD_METRICS_HIST_BUCKETS];
+};
+
+struct lockd_metrics_page {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t n_counters;
+	uint32_t n_hists;
+	uint32_t n_buckets;
+	uint32_t bucket_base_us;
+	uint64_t start_us;
+	struct lockd_metrics_counter counter[LOCKD_CNT_MAX];
+	struct lockd_metrics_hist hist[LOCKD_HIST_MAX];
+};
+
+#pragma GCC visibility push(default)
+
+int lockd_metrics_init(void);
+
+const struct lockd_metrics_page *lockd_metrics_get(void);
+
+uint64_t lockd_metrics_now(void);
+
+void lockd_metrics_inc(enum lockd_metrics_counter_id id);
+
+void lockd_metrics_add(enum lockd_metrics_counter_id id, uint64_t n);
+
+void lockd_metrics_observe(enum lockd_metrics_hist_id id, uint64_t usec);
+
+void lockd_metrics_observe_since(enum lockd_metrics_hist_id id,
+				 uint64_t start_us);
+
+#pragma GCC visibility pop
+
+#endif				/* __LOCKD_METRICS_H__ */
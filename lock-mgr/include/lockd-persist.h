@@ -0,0 +1,51 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LOCKD_PERSIST_H__
+#define __LOCKD_PERSIST_H__
+
+/*
+ * Lock state kept in a small file under /run, so that a restarted daemon
+ * takes back the lock app a crashed or stopped one left on screen instead
+ * of launching another. Per screen : lock state, lock app pid and the start
+ * time of that process, lock window, and the package it was launched from.
+ *
+ * The file holds two records. A write goes to the older one with the next
+ * sequence number and a checksum, so a record torn by a crash is skipped
+ * in favour of the previous one. Main loop only.
+ *
+ * STARTER_LOCK_PERSIST replaces the file, an empty value disables it.
+ */
+
+int lockd_persist_init(void);
+
+/*
+ * The state of screen as the last daemon left it, VCONFKEY_IDLE_LOCK or
+ * VCONFKEY_IDLE_UNLOCK. *pid is the lock app if it is still the same
+ * process of the configured package, 0 otherwise. *window is the lock
+ * window that daemon matched for it, 0 if none : it may be gone by now.
+ */
+int lockd_persist_restore(int screen, int *pid, unsigned int *window);
+
+void lockd_persist_lock(int screen, int pid);
+
+void lockd_persist_window(int screen, unsigned int window);
+
+void lockd_persist_unlock(int screen);
+
+void lockd_persist_fini(void);
+
+#endif				/* __LOCKD_PERSIST_H__ */
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LOCKD_PLUGIN_H__
+#define __LOCKD_PLUGIN_H__
+
+typedef struct _lockd_plugin lockd_plugin;
+
+/* TRUE if pkgname may name a plugin file, anything else is never loaded */
+int lockd_plugin_name_valid(const char *pkgname);
+
+/*
+ * The plugin instance of pkgname for the given screen, created on first use.
+ * NULL if pkgname has no plugin or the plugin could not be set up, the lock
+ * app is launched then.
+ */
+lockd_plugin *lockd_plugin_get(const char *pkgname, int screen,
+			       void (*unlock_cb) (void *), void *data);
+
+/*
+ * TRUE while a screen is still locked by the plugin of another package :
+ * whether pkgname has one is only known once that screen is unlocked, until
+ * then lockd_plugin_get() returns NULL for it.
+ */
+int lockd_plugin_pending(const char *pkgname);
+
+/* returns the plugin's lock window, 0 on failure */
+unsigned int lockd_plugin_show(lockd_plugin * plugin);
+
+void lockd_plugin_hide(lockd_plugin * plugin);
+
+void lockd_plugin_fini(void);
+
+#endif				/* __LOCKD_PLUGIN_H__ */
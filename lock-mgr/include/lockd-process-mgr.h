@@ -17,9 +17,27 @@
 #ifndef __LOCKD_PROCESS_MGR_H__
 #define __LOCKD_PROCESS_MGR_H__
 
-int lockd_process_mgr_start_lock(void *data, int (*dead_cb) (int, void *));
+void lockd_process_mgr_init(int n_screens);
 
-int lockd_process_mgr_restart_lock(void);
+void lockd_process_mgr_fini(void);
+
+/* the configured lock screen package */
+const char *lockd_process_mgr_get_pkgname(void);
+
+/* the same, from any thread */
+void lockd_process_mgr_copy_pkgname(char *buf, int len);
+
+/* any thread : the app dead signal is listened to once, on the main loop */
+int lockd_process_mgr_start_lock(int screen);
+
+/* over the relock channel if the app is on it, else through aul */
+int lockd_process_mgr_restart_lock(int lock_app_pid, int screen);
+
+/*
+ * Starts the lock app with "mode" "prepare" : it gets ready but shows nothing
+ * until restart_lock() shows it. A single launch attempt.
+ */
+int lockd_process_mgr_prepare_lock(int screen);
 
 void lockd_process_mgr_terminate_lock_app(int lock_app_pid,
 					  int state);
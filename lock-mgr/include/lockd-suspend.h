@@ -0,0 +1,51 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LOCKD_SUSPEND_H__
+#define __LOCKD_SUSPEND_H__
+
+/*
+ * Suspend blocker held from LCD off until the lock window of every screen
+ * locking is confirmed, so the device cannot go to sleep with the launch
+ * half done and come back showing the unlocked screen. It is bounded : after
+ * SUSPEND_TIMEOUT_MS (STARTER_SUSPEND_TIMEOUT_MS) it is dropped whatever
+ * the screens are waiting for.
+ *
+ * STARTER_SUSPEND_BLOCKER picks the backend : "sysfs" for the kernel's
+ * /sys/power/wake_lock, "local" for an in-process stand-in that only keeps
+ * the state, "none" to never block. Without it sysfs is used if it can be
+ * opened.
+ *
+ * block and release may be called from any thread, init and fini from the
+ * main loop, which also handles the timeout.
+ */
+
+int lockd_suspend_init(void);
+
+/* screen starts waiting for its lock window */
+void lockd_suspend_block(int screen);
+
+/* screen no longer waits, the blocker goes with the last one */
+void lockd_suspend_release(int screen);
+
+void lockd_suspend_fini(void);
+
+#pragma GCC visibility push(default)
+/* TRUE while the blocker is held */
+int lockd_suspend_blocked(void);
+#pragma GCC visibility pop
+
+#endif				/* __LOCKD_SUSPEND_H__ */
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LOCKD_TRACE_H__
+#define __LOCKD_TRACE_H__
+
+/*
+ * USDT probes of provider "starter", for perf probe and bpftrace. With
+ * sys/sdt.h a probe is a single nop and an ELF note, its arguments are only
+ * read once a tracer attaches to it. Without it the probes compile to
+ * nothing. tools/lock-latency.bt shows how they fit together.
+ *
+ * Boot side (starter) :
+ *   init_begin, init_theme_set, init_lock_daemon, init_end
+ *   hib_leave_begin, hib_leave_end
+ *   pwlock_launch_begin, pwlock_launch_end(result)
+ *
+ * Lock side (liblock-daemon) :
+ *   pm_state(state)             vconf notification on the main loop
+ *   fastpath_pm_state(state)    the same, seen by the lock fast path thread
+ *   check_lock(pid, running)
+ *   launch_begin(pkgname)
+ *   launch_end(pkgname, pid)    pid < 0 is the aul error code
+ *   window_props(window)        the lock window got its properties
+ *   window_matched(screen, pid)
+ *   lock_visible(screen, pid)   first paint of the lock window after map
+ *   unlock(screen)
+ *   app_dead(pid)
+ */
+
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+
+#define STARTER_TRACE(name)		DTRACE_PROBE(starter, name)
+#define STARTER_TRACE1(name, a)		DTRACE_PROBE1(starter, name, a)
+#define STARTER_TRACE2(name, a, b)	DTRACE_PROBE2(starter, name, a, b)
+#else
+#define STARTER_TRACE(name)		do { } while (0)
+#define STARTER_TRACE1(name, a)		do { } while (0)
+#define STARTER_TRACE2(name, a, b)	do { } while (0)
+#endif
+
+#endif				/* __LOCKD_TRACE_H__ */
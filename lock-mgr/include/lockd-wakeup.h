@@ -0,0 +1,46 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LOCKD_WAKEUP_H__
+#define __LOCKD_WAKEUP_H__
+
+/*
+ * Wakeup accounting. Enabled by STARTER_WAKEUP_AUDIT=1 in the environment,
+ * otherwise every call below returns right away.
+ *
+ * Every main loop wakeup is attributed to the fds that became ready or to
+ * a timer, and handlers mark themselves with lockd_wakeup_source(), which
+ * also names them to the watchdog (lockd-watchdog.h). While
+ * the screen is off the counts are kept separately and reported as
+ * wakeups per minute when the screen comes back on.
+ */
+
+#pragma GCC visibility push(default)
+
+void lockd_wakeup_init(void);
+
+void lockd_wakeup_source(const char *name);
+
+void lockd_wakeup_idle_begin(void);
+
+/* main loop wakeups since the screen last went off */
+unsigned int lockd_wakeup_idle_count(void);
+
+void lockd_wakeup_idle_end(void);
+
+#pragma GCC visibility pop
+
+#endif				/* __LOCKD_WAKEUP_H__ */
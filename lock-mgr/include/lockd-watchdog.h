@@ -0,0 +1,44 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LOCKD_WATCHDOG_H__
+#define __LOCKD_WATCHDOG_H__
+
+/*
+ * Main loop watchdog. Enabled by STARTER_WATCHDOG_MS=<threshold> in the
+ * environment, otherwise lockd_watchdog_init() does nothing.
+ *
+ * Every main loop iteration is timed from select() returning to the next
+ * select() call, and goes into the "loop_iteration" histogram. A thread
+ * checks the running iteration, and when it has been going for longer
+ * than the threshold it takes the main thread's stack (SIGUSR2 and
+ * backtrace()) and logs a stall record : how long, the handler that
+ * marked itself with lockd_wakeup_source(), the fd that woke the loop up,
+ * and the frames. Each stall is reported once.
+ *
+ * Must be called from the main thread.
+ */
+
+#pragma GCC visibility push(default)
+
+void lockd_watchdog_init(void);
+
+/* the handler now running on the main loop, name must stay valid */
+void lockd_watchdog_handler(const char *name);
+
+#pragma GCC visibility pop
+
+#endif				/* __LOCKD_WATCHDOG_H__ */
@@ -19,10 +19,31 @@
 
 typedef struct _lockw_data lockw_data;
 
-void
+int lockd_window_event_window(void *event);
+
+int lockd_window_event_pid(void *event);
+
+/* the damaged window of an ECORE_X_EVENT_DAMAGE_NOTIFY */
+int lockd_window_event_drawable(void *event);
+
+/* marks win as the lock screen of this context's X screen */
+void lockd_window_mgr_set_lock_window(lockw_data * lockw, Ecore_X_Window win);
+
+Ecore_X_Window lockd_window_mgr_get_lock_window(lockw_data * lockw);
+
+int
 lockd_window_set_window_property(lockw_data * data, int lock_app_pid,
 				 void *event);
 
+/* TRUE if the lock app already has a window, *shown tells if it is mapped */
+int lockd_window_mgr_find_lock_window(lockw_data * lockw, int lock_app_pid,
+				      int *shown);
+
+/* the same for a window known beforehand, TRUE if it still is the lock
+ * app's : no scan of the screen's windows */
+int lockd_window_mgr_bind_lock_window(lockw_data * lockw, Ecore_X_Window win,
+				      int lock_app_pid, int *shown);
+
 void
 lockd_window_set_window_effect(lockw_data * data, int lock_app_pid,
 			       void *event);
@@ -34,6 +55,30 @@ lockd_window_mgr_ready_lock(void *data, lockw_data * lockw,
 
 void lockd_window_mgr_finish_lock(lockw_data * lockw);
 
-lockw_data *lockd_window_init(void);
+void lockd_window_mgr_stop_sniff(lockw_data * lockw);
+
+void lockd_window_mgr_show_placeholder(lockw_data * lockw);
+
+void lockd_window_mgr_hide_placeholder(lockw_data * lockw);
+
+void lockd_window_mgr_lock_shown(lockw_data * lockw);
+
+/*
+ * Watches the lock window for its first paint, damage_cb gets the damage
+ * events. FALSE if the X server cannot report damage.
+ */
+int
+lockd_window_mgr_watch_damage(void *data, lockw_data * lockw,
+			      Eina_Bool(*damage_cb) (void *, int, void *));
+
+/* TRUE once, on the first damage of the lock window while it is mapped */
+int lockd_window_mgr_lock_painted(lockw_data * lockw, void *event);
+
+/* the window the lock keys are grabbed on (lockd-keys.h) */
+Ecore_X_Window lockd_window_mgr_get_input_window(lockw_data * lockw);
+
+lockw_data *lockd_window_init(Ecore_X_Window root);
+
+void lockd_window_fini(lockw_data * lockw);
 
 #endif				/* __LOCKD_WINDOW_MGR_H__ */
@@ -15,11 +15,13 @@
  */
 
 #include <Elementary.h>
+#include <Ecore_X.h>
 
 #include <vconf.h>
 #include <vconf-keys.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <sys/un.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -28,15 +30,65 @@
 #include <unistd.h>
 #include <sys/param.h>
 #include <errno.h>
+#include <pthread.h>
+#include <aul.h>
 
 #include "lockd-debug.h"
+#include "lockd-metrics.h"
+#include "lockd-lockstate.h"
+#include "lockd-wakeup.h"
+#include "lockd-watchdog.h"
+#include "lockd-journal.h"
 #include "lock-daemon.h"
 #include "lockd-process-mgr.h"
 #include "lockd-window-mgr.h"
+#include "lockd-plugin.h"
+#include "lockd-fastpath.h"
+#include "lockd-channel.h"
+#include "lockd-control.h"
+#include "lockd-keys.h"
+#include "lockd-suspend.h"
+#include "lockd-trace.h"
+#include "lockd-persist.h"
+#include "lockd-boost.h"
+#include "starter-vconf.h"
+#include "starter-lock-control.h"
+
+/* up to LOCKD_SCREEN_MAX X screens, each with its own lock context */
+#define LOCKD_SCREEN_MAX 8
+#define LOCKD_SCREEN_BITS 3
+#define LOCKD_PKGNAME_MAX 128
+
+struct lockd_daemon;
 
 struct lockd_data {
+	struct lockd_daemon *daemon;
+	int screen;
 	int lock_app_pid;
 	lockw_data *lockw;
+	uint64_t lock_start_us;
+	/* LCD off of a matched lock window that has not been painted yet */
+	uint64_t visible_start_us;
+	/* set while an in-process lock plugin is the lock screen */
+	lockd_plugin *plugin;
+};
+
+/*
+ * State shared by every screen : the vconf, aul and noti subscriptions are
+ * made once and dispatched to the contexts from here.
+ */
+struct lockd_daemon {
+	struct lockd_data lockd[LOCKD_SCREEN_MAX];
+	int n_lockd;
+	int power_off;
+	/*
+	 * The lock screen package the fast path handles, and whether it has a
+	 * plugin. The main loop updates them after a package change, the fast
+	 * path thread reads them under pkg_lock.
+	 */
+	pthread_mutex_t pkg_lock;
+	int has_plugin;
+	char pkgname[LOCKD_PKGNAME_MAX];
 };
 
 #define LAUNCH_INTERVAL 100*1000
@@ -45,26 +97,334 @@ static void lockd_launch_lockscreen(struct lockd_data *lockd);
 static void lockd_launch_app_lockscreen(struct lockd_data *lockd);
 
 static void lockd_unlock_lockscreen(struct lockd_data *lockd);
+static int lockd_init_plugin(struct lockd_daemon *daemon);
+
+static lock_daemon_noti_subscriber lockd_noti_subscribe = NULL;
+static lock_daemon_noti_subscriber lockd_noti_unsubscribe = NULL;
+
+static struct lockd_daemon *lockd_instance = NULL;
+
+/*
+ * LCD off handled by the fast path thread, one job per screen. The thread
+ * decides and launches, the main loop does the window work before and after
+ * the launch. Calls still queued on the main loop when the daemon stops carry
+ * an old generation and do nothing.
+ * The speculative launch state is only touched while holding busy : by the
+ * LCD off that owns the job, wherever it runs, or by an LCD dim or normal
+ * that found the job idle.
+ */
+struct lockd_fastpath_job {
+	int busy;
+	int pid;
+	uint64_t start_us;
+	/* the lock app started hidden on LCD dim */
+	int spec_pid;
+	int spec_wasted;
+};
+
+static struct lockd_fastpath_job lockd_jobs[LOCKD_SCREEN_MAX];
+static unsigned int lockd_generation = 0;
+
+#define LOCKD_GENERATION_MASK	(UINTPTR_MAX >> LOCKD_SCREEN_BITS)
+
+static void *lockd_job_data(int screen)
+{
+	return (void *)(((uintptr_t)lockd_generation << LOCKD_SCREEN_BITS)
+			| screen);
+}
+
+static struct lockd_data *lockd_job_context(void *data)
+{
+	uintptr_t v = (uintptr_t)data;
+
+	if (lockd_instance == NULL
+	    || (v >> LOCKD_SCREEN_BITS) !=
+	    (lockd_generation & LOCKD_GENERATION_MASK))
+		return NULL;
+
+	return &lockd_instance->lockd[v & (LOCKD_SCREEN_MAX - 1)];
+}
+
+static struct lockd_data *lockd_find_by_pid(struct lockd_daemon *daemon,
+					    int pid)
+{
+	int i;
+
+	if (pid <= 0)
+		return NULL;
+
+	for (i = 0; i < daemon->n_lockd; i++) {
+		if (daemon->lockd[i].lock_app_pid == pid)
+			return &daemon->lockd[i];
+	}
+
+	return NULL;
+}
+
+static int lockd_any_locked(struct lockd_daemon *daemon)
+{
+	int i;
+
+	for (i = 0; i < daemon->n_lockd; i++) {
+		if (daemon->lockd[i].lock_app_pid > 0
+		    || daemon->lockd[i].plugin != NULL)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* the shared page, control subscribers, then vconf for everybody else */
+static void lockd_set_lock_state(int state, int pid)
+{
+	lockd_lockstate_publish(state, pid);
+	lockd_control_event(state, pid);
+	lockd_journal_record(LOCKD_JOURNAL_SET_LOCK_STATE, state, 0);
+	vconf_set_int(VCONFKEY_IDLE_LOCK_STATE, state);
+}
+
+/* the lock keys are grabbed exactly while the screen is locked */
+static void lockd_update_keys(struct lockd_data *lockd)
+{
+	Ecore_X_Window win = lockd_window_mgr_get_input_window(lockd->lockw);
+
+	if (lockd->lock_app_pid > 0 || lockd->plugin != NULL)
+		lockd_keys_grab(win, lockd);
+	else
+		lockd_keys_ungrab(win);
+}
+
+/*
+ * Speculative launch : a timeout LCD off comes after LCD dim, so the lock app
+ * can be started hidden then and LCD off only has to show it. The value of
+ * VCONF_PRIVATE_LOCKSCREEN_SPECULATIVE is how many dims in a row may go back
+ * to normal before the hidden app is terminated, the next lock starts the
+ * count again.
+ */
+static int lockd_speculative_cap(void)
+{
+	int cap = 0;
+
+	if (vconf_get_int(VCONF_PRIVATE_LOCKSCREEN_SPECULATIVE, &cap) < 0)
+		return 0;
+
+	return cap;
+}
+
+/* with job->busy held */
+static void _lockd_speculate(struct lockd_data *lockd,
+			     struct lockd_fastpath_job *job)
+{
+	int cap;
+	int pid;
+
+	/* already locked, the last LCD off has set it before releasing busy */
+	if (*(volatile int *)&lockd->lock_app_pid > 0)
+		return;
+
+	cap = lockd_speculative_cap();
+	if (cap <= 0 || job->spec_wasted >= cap)
+		return;
+
+	/* still parked from the last dim */
+	if (job->spec_pid > 0
+	    && lockd_process_mgr_check_lock(job->spec_pid) == TRUE)
+		return;
+
+	pid = lockd_process_mgr_prepare_lock(lockd->screen);
+	if (pid < 0) {
+		LOCKD_DBG("Cannot prepare lock app [%d]", pid);
+		job->spec_pid = 0;
+		return;
+	}
+
+	lockd_metrics_inc(LOCKD_CNT_SPEC_LAUNCH);
+	job->spec_pid = pid;
+}
+
+static void lockd_speculate(struct lockd_data *lockd)
+{
+	struct lockd_fastpath_job *job = &lockd_jobs[lockd->screen];
+
+	if (lockd->daemon->has_plugin)
+		return;
+
+	/* an LCD off of this screen is on its way */
+	if (!__sync_bool_compare_and_swap(&job->busy, 0, 1))
+		return;
+
+	_lockd_speculate(lockd, job);
+	__sync_lock_release(&job->busy);
+}
+
+/* with job->busy held */
+static void _lockd_speculate_park(struct lockd_fastpath_job *job)
+{
+	if (job->spec_pid <= 0)
+		return;
+
+	job->spec_wasted++;
+	if (job->spec_wasted < lockd_speculative_cap())
+		return;
+
+	LOCKD_DBG("%d dims without LCD off, terminate lock app(pid : %d)",
+		  job->spec_wasted, job->spec_pid);
+	lockd_process_mgr_terminate_lock_app(job->spec_pid, 1);
+	lockd_metrics_inc(LOCKD_CNT_SPEC_CANCEL);
+	job->spec_pid = 0;
+}
+
+/* LCD dim went back to normal : the app stays parked, up to the cap */
+static void lockd_speculate_park(struct lockd_data *lockd)
+{
+	struct lockd_fastpath_job *job = &lockd_jobs[lockd->screen];
+
+	/* the LCD off on its way takes the app anyway */
+	if (!__sync_bool_compare_and_swap(&job->busy, 0, 1))
+		return;
+
+	_lockd_speculate_park(job);
+	__sync_lock_release(&job->busy);
+}
+
+static void lockd_speculate_drop(struct lockd_data *lockd)
+{
+	struct lockd_fastpath_job *job = &lockd_jobs[lockd->screen];
+
+	if (job->spec_pid > 0)
+		lockd_process_mgr_terminate_lock_app(job->spec_pid, 1);
+	job->spec_pid = 0;
+}
+
+/* LCD off : the hidden app if it is still alive, 0 otherwise */
+static int lockd_speculate_take(struct lockd_data *lockd)
+{
+	struct lockd_fastpath_job *job = &lockd_jobs[lockd->screen];
+	int pid = job->spec_pid;
+
+	job->spec_pid = 0;
+	job->spec_wasted = 0;
+
+	if (pid <= 0 || lockd_process_mgr_check_lock(pid) != TRUE)
+		return 0;
+
+	return pid;
+}
+
+/* the pid now showing the lock screen, < 0 if it has to be launched */
+static int lockd_speculate_show(struct lockd_data *lockd, int pid)
+{
+	int r;
+
+	r = lockd_process_mgr_restart_lock(pid, lockd->screen);
+	if (r < 0) {
+		LOCKD_DBG("Showing prepared lock app(pid : %d) is fail [%d].",
+			  pid, r);
+		return r;
+	}
+
+	lockd_metrics_inc(LOCKD_CNT_SPEC_HIT);
+	lockd_boost_start(r);
+	LOCKD_DBG("Prepared lock app shown, pid[%d].", r);
+
+	return r;
+}
+
+/* main loop LCD off or lock request : no suspend until the window is up */
+static void lockd_lock_now(struct lockd_data *lockd)
+{
+	struct lockd_fastpath_job *job = &lockd_jobs[lockd->screen];
+
+	/* it may take the prepared app, as the fast path does */
+	if (!__sync_bool_compare_and_swap(&job->busy, 0, 1)) {
+		LOCKD_DBG("LCD off of screen %d is already handled",
+			  lockd->screen);
+		return;
+	}
+
+	lockd_suspend_block(lockd->screen);
+	lockd->lock_start_us = lockd_metrics_now();
+	lockd_launch_app_lockscreen(lockd);
+
+	/* not launched, or its window is already there */
+	if (lockd->lock_start_us == 0)
+		lockd_suspend_release(lockd->screen);
+
+	__sync_lock_release(&job->busy);
+}
 
 static void _lockd_notify_pm_state_cb(keynode_t * node, void *data)
 {
 	LOCKD_DBG("PM state Notification!!");
 
-	struct lockd_data *lockd = (struct lockd_data *)data;
+	struct lockd_daemon *daemon = (struct lockd_daemon *)data;
 	int val = -1;
+	int i;
 
-	if (lockd == NULL) {
-		LOCKD_ERR("lockd is NULL");
+	lockd_wakeup_source("vconf pm state");
+
+	if (daemon == NULL) {
+		LOCKD_ERR("lock daemon is NULL");
 		return;
 	}
 
-	if (vconf_get_int(VCONFKEY_PM_STATE, &val) < 0) {
+	/* the notification already carries the value */
+	if (node != NULL) {
+		val = vconf_keynode_get_int(node);
+	} else if (vconf_get_int(VCONFKEY_PM_STATE, &val) < 0) {
 		LOCKD_ERR("Cannot get VCONFKEY_PM_STATE");
 		return;
 	}
 
-	if (val == VCONFKEY_PM_STATE_LCDOFF) {
-		lockd_launch_app_lockscreen(lockd);
+	lockd_journal_record(LOCKD_JOURNAL_PM_STATE, val, 0);
+	STARTER_TRACE1(pm_state, val);
+
+	if (val == VCONFKEY_PM_STATE_LCDOFF)
+		lockd_wakeup_idle_begin();
+	else
+		lockd_wakeup_idle_end();
+
+	/* the fast path locks, it may have seen this state before us */
+	if (lockd_fastpath_enabled()) {
+		lockd_fastpath_pm_state(val);
+		return;
+	}
+
+	if (daemon->power_off) {
+		LOCKD_DBG("Power off in progress, ignore PM state(%d)", val);
+		return;
+	}
+
+	for (i = 0; i < daemon->n_lockd; i++) {
+		switch (val) {
+		case VCONFKEY_PM_STATE_LCDDIM:
+			lockd_speculate(&daemon->lockd[i]);
+			break;
+		case VCONFKEY_PM_STATE_NORMAL:
+			lockd_speculate_park(&daemon->lockd[i]);
+			break;
+		case VCONFKEY_PM_STATE_LCDOFF:
+			lockd_lock_now(&daemon->lockd[i]);
+			break;
+		}
+	}
+}
+
+/* releases every screen, lock apps go once they are dead */
+static void lockd_unlock_all(struct lockd_daemon *daemon)
+{
+	int i;
+
+	for (i = 0; i < daemon->n_lockd; i++) {
+		if (daemon->lockd[i].plugin != NULL) {
+			lockd_unlock_lockscreen(&daemon->lockd[i]);
+			continue;
+		}
+		if (daemon->lockd[i].lock_app_pid <= 0)
+			continue;
+		LOCKD_DBG("terminate lock app..!! (screen %d)", i);
+		lockd_process_mgr_terminate_lock_app(daemon->lockd[i].
+						     lock_app_pid, 1);
 	}
 }
 
@@ -73,25 +433,29 @@ _lockd_notify_lock_state_cb(keynode_t * node, void *data)
 {
 	LOCKD_DBG("lock state changed!!");
 
-	struct lockd_data *lockd = (struct lockd_data *)data;
+	struct lockd_daemon *daemon = (struct lockd_daemon *)data;
 	int val = -1;
 
-	if (lockd == NULL) {
-		LOCKD_ERR("lockd is NULL");
+	lockd_wakeup_source("vconf lock state");
+
+	if (daemon == NULL) {
+		LOCKD_ERR("lock daemon is NULL");
 		return;
 	}
 
-	if (vconf_get_int(VCONFKEY_IDLE_LOCK_STATE, &val) < 0) {
+	if (node != NULL) {
+		val = vconf_keynode_get_int(node);
+	} else if (vconf_get_int(VCONFKEY_IDLE_LOCK_STATE, &val) < 0) {
 		LOCKD_ERR("Cannot get VCONFKEY_IDLE_LOCK_STATE");
 		return;
 	}
 
+	lockd_journal_record(LOCKD_JOURNAL_LOCK_STATE, val, 0);
+
+	/* the key is the state of all screens, unlock releases every one */
 	if (val == VCONFKEY_IDLE_UNLOCK) {
 		LOCKD_DBG("unlocked..!!");
-		if (lockd->lock_app_pid != 0) {
-			LOCKD_DBG("terminate lock app..!!");
-			lockd_process_mgr_terminate_lock_app(lockd->lock_app_pid, 1);
-		}
+		lockd_unlock_all(daemon);
 	}
 }
 
@@ -99,27 +463,103 @@ static int lockd_app_dead_cb(int pid, void *data)
 {
 	LOCKD_DBG("app dead cb call! (pid : %d)", pid);
 
-	struct lockd_data *lockd = (struct lockd_data *)data;
+	struct lockd_daemon *daemon = (struct lockd_daemon *)data;
+	struct lockd_data *lockd;
+
+	lockd_wakeup_source("aul app dead");
+	lockd_journal_record(LOCKD_JOURNAL_APP_DEAD, pid, 0);
+	STARTER_TRACE1(app_dead, pid);
 
-	if (pid == lockd->lock_app_pid ) {
-		LOCKD_DBG("lock app(pid:%d) is destroyed.", pid);
+	if (daemon == NULL)
+		return 0;
+
+	lockd = lockd_find_by_pid(daemon, pid);
+	if (lockd != NULL) {
+		LOCKD_DBG("lock app(pid:%d) of screen %d is destroyed.", pid,
+			  lockd->screen);
+		lockd_metrics_inc(LOCKD_CNT_APP_DEAD);
 		lockd_unlock_lockscreen(lockd);
 	}
 	return 0;
 }
 
+/* what the user waited for, the lock latency to optimize */
+static void lockd_window_visible(struct lockd_data *lockd)
+{
+	uint64_t us;
+
+	if (lockd->visible_start_us == 0)
+		return;
+
+	us = lockd_metrics_now() - lockd->visible_start_us;
+	lockd->visible_start_us = 0;
+
+	STARTER_TRACE2(lock_visible, lockd->screen, lockd->lock_app_pid);
+	lockd_metrics_observe(LOCKD_HIST_LOCK_VISIBLE, us);
+	LOCKD_DBG("lock screen %d visible %llu us after LCD off",
+		  lockd->screen, (unsigned long long)us);
+}
+
+static Eina_Bool lockd_app_damage_cb(void *data, int type, void *event)
+{
+	struct lockd_data *lockd = (struct lockd_data *)data;
+
+	lockd_wakeup_source("x damage");
+
+	if (lockd_journal_enabled()) {
+		lockd_journal_record(LOCKD_JOURNAL_WIN_DAMAGE,
+				     lockd_window_event_drawable(event), 0);
+	}
+	if (lockd_window_mgr_lock_painted(lockd->lockw, event) == TRUE)
+		lockd_window_visible(lockd);
+
+	/* the other screens watch their own lock windows */
+	return ECORE_CALLBACK_PASS_ON;
+}
+
+static void lockd_window_matched(struct lockd_data *lockd)
+{
+	lockd_suspend_release(lockd->screen);
+	lockd_persist_window(lockd->screen,
+			     lockd_window_mgr_get_lock_window(lockd->lockw));
+	lockd_boost_end(lockd->lock_app_pid);
+
+	if (lockd->lock_start_us == 0)
+		return;
+
+	STARTER_TRACE2(window_matched, lockd->screen, lockd->lock_app_pid);
+	lockd_metrics_observe_since(LOCKD_HIST_LOCK_LATENCY,
+				    lockd->lock_start_us);
+	lockd->visible_start_us = lockd->lock_start_us;
+	lockd->lock_start_us = 0;
+
+	if (lockd_window_mgr_watch_damage(lockd, lockd->lockw,
+					  lockd_app_damage_cb) == FALSE) {
+		lockd_metrics_inc(LOCKD_CNT_VISIBLE_NO_DAMAGE);
+		lockd_window_visible(lockd);
+	}
+}
+
 static Eina_Bool lockd_app_create_cb(void *data, int type, void *event)
 {
 	struct lockd_data *lockd = (struct lockd_data *)data;
 
+	lockd_wakeup_source("x window create");
+
 	if (lockd == NULL) {
 		return EINA_TRUE;
 	}
+	if (lockd_journal_enabled()) {
+		lockd_journal_record(LOCKD_JOURNAL_WIN_CREATE,
+				     lockd_window_event_window(event),
+				     lockd_window_event_pid(event));
+	}
 	LOCKD_DBG("%s, %d", __func__, __LINE__);
 	lockd_window_set_window_effect(lockd->lockw, lockd->lock_app_pid,
 				       event);
-	lockd_window_set_window_property(lockd->lockw, lockd->lock_app_pid,
-					 event);
+	if (lockd_window_set_window_property(lockd->lockw, lockd->lock_app_pid,
+					     event) == TRUE)
+		lockd_window_matched(lockd);
 	return EINA_FALSE;
 }
 
@@ -127,53 +567,357 @@ static Eina_Bool lockd_app_show_cb(void *data, int type, void *event)
 {
 	struct lockd_data *lockd = (struct lockd_data *)data;
 
+	lockd_wakeup_source("x window show");
+
 	if (lockd == NULL) {
 		return EINA_TRUE;
 	}
+	if (lockd_journal_enabled()) {
+		lockd_journal_record(LOCKD_JOURNAL_WIN_SHOW,
+				     lockd_window_event_window(event),
+				     lockd_window_event_pid(event));
+	}
 	LOCKD_DBG("%s, %d", __func__, __LINE__);
-	lockd_window_set_window_property(lockd->lockw, lockd->lock_app_pid,
-					 event);
+	if (lockd_window_set_window_property(lockd->lockw, lockd->lock_app_pid,
+					     event) == TRUE) {
+		lockd_window_matched(lockd);
+		/* lock window is up, other clients' windows are of no interest */
+		lockd_window_mgr_lock_shown(lockd->lockw);
+	}
 
 	return EINA_FALSE;
 }
 
+static void _lockd_plugin_unlock_cb(void *data)
+{
+	struct lockd_data *lockd = (struct lockd_data *)data;
+
+	LOCKD_DBG("lock plugin of screen %d unlocked", lockd->screen);
+
+	if (lockd->plugin != NULL)
+		lockd_unlock_lockscreen(lockd);
+}
+
+/* returns TRUE if the configured package has a plugin and it is shown */
+static int lockd_launch_plugin_lockscreen(struct lockd_data *lockd)
+{
+	lockd_plugin *plugin;
+	unsigned int xwin;
+
+	plugin = lockd_plugin_get(lockd_process_mgr_get_pkgname(),
+				  lockd->screen, _lockd_plugin_unlock_cb,
+				  lockd);
+	if (plugin == NULL)
+		return FALSE;
+
+	xwin = lockd_plugin_show(plugin);
+	if (xwin == 0) {
+		LOCKD_ERR("lock plugin failed, launch the lock app instead");
+		return FALSE;
+	}
+
+	lockd->plugin = plugin;
+	lockd_window_mgr_set_lock_window(lockd->lockw, xwin);
+	lockd_window_matched(lockd);
+
+	lockd_metrics_inc(LOCKD_CNT_LOCK);
+	lockd_metrics_inc(LOCKD_CNT_PLUGIN_LOCK);
+	lockd_persist_lock(lockd->screen, 0);
+	lockd_update_keys(lockd);
+	lockd_set_lock_state(VCONFKEY_IDLE_LOCK, getpid());
+
+	return TRUE;
+}
+
+/* a window the lock app made before the daemon was watching for it */
+static void lockd_find_lock_window(struct lockd_data *lockd)
+{
+	int shown = FALSE;
+
+	if (lockd_window_mgr_find_lock_window(lockd->lockw, lockd->lock_app_pid,
+					      &shown) == TRUE) {
+		lockd_window_matched(lockd);
+		if (shown)
+			lockd_window_mgr_lock_shown(lockd->lockw);
+	}
+}
+
 static void lockd_launch_app_lockscreen(struct lockd_data *lockd)
 {
 	LOCKD_DBG("launch app lock screen");
 
 	int call_state = -1, phlock_state = -1;
+	int spec_pid;
 	int r = 0;
 
+	if (lockd->plugin != NULL) {
+		LOCKD_DBG("Lock plugin is already shown.");
+		lockd->lock_start_us = 0;
+		return;
+	}
+
 	if (lockd_process_mgr_check_lock(lockd->lock_app_pid) == TRUE) {
 		LOCKD_DBG("Lock Screen App is already running.");
-		r = lockd_process_mgr_restart_lock();
+		r = lockd_process_mgr_restart_lock(lockd->lock_app_pid,
+						   lockd->screen);
 		if (r < 0) {
 			LOCKD_DBG("Restarting Lock Screen App is fail [%d].", r);
 			usleep(LAUNCH_INTERVAL);
 		} else {
 			LOCKD_DBG("Restarting Lock Screen App, pid[%d].", r);
+			lockd->lock_start_us = 0;
 			return;
 		}
 	}
 
 	vconf_get_int(VCONFKEY_CALL_STATE, &call_state);
+	lockd_journal_record(LOCKD_JOURNAL_CALL_STATE, call_state, 0);
 	if (call_state != VCONFKEY_CALL_OFF) {
 		LOCKD_DBG
 		    ("Current call state(%d) does not allow to launch lock screen.",
 		     call_state);
+		lockd->lock_start_us = 0;
 		return;
 	}
 
-	lockd->lock_app_pid =
-	    lockd_process_mgr_start_lock(lockd, lockd_app_dead_cb);
+	/* an in-process plugin needs neither a launch nor a placeholder */
+	if (lockd_launch_plugin_lockscreen(lockd) == TRUE)
+		return;
+
+	spec_pid = lockd_speculate_take(lockd);
+
+	/* cover the screen right away, the lock app takes over when it shows */
+	lockd_window_mgr_show_placeholder(lockd->lockw);
+	lockd_metrics_inc(LOCKD_CNT_PLACEHOLDER);
+	lockd_metrics_observe_since(LOCKD_HIST_PLACEHOLDER,
+				    lockd->lock_start_us);
+
+	/* watch for the window before the app can create it */
+	lockd_window_mgr_ready_lock(lockd, lockd->lockw, lockd_app_create_cb,
+				    lockd_app_show_cb);
+
+	lockd_metrics_observe_since(LOCKD_HIST_LCDOFF_LAUNCH,
+				    lockd->lock_start_us);
+	lockd->lock_app_pid = -1;
+	if (spec_pid > 0)
+		lockd->lock_app_pid = lockd_speculate_show(lockd, spec_pid);
 	if (lockd->lock_app_pid < 0)
+		lockd->lock_app_pid =
+		    lockd_process_mgr_start_lock(lockd->screen);
+	if (lockd->lock_app_pid < 0) {
+		lockd_window_mgr_finish_lock(lockd->lockw);
+		lockd->lock_app_pid = 0;
+		lockd->lock_start_us = 0;
+		return;
+	}
+
+	lockd_metrics_inc(LOCKD_CNT_LOCK);
+	lockd_persist_lock(lockd->screen, lockd->lock_app_pid);
+	lockd_boost_protect(lockd->lock_app_pid);
+	lockd_update_keys(lockd);
+	lockd_set_lock_state(VCONFKEY_IDLE_LOCK, lockd->lock_app_pid);
+
+	if (spec_pid > 0)
+		lockd_find_lock_window(lockd);
+}
+
+/* main loop : cover the screen and watch for the window being launched */
+static void _lockd_fastpath_arm_cb(void *data)
+{
+	struct lockd_data *lockd = lockd_job_context(data);
+
+	if (lockd == NULL)
 		return;
 
-	vconf_set_int(VCONFKEY_IDLE_LOCK_STATE, VCONFKEY_IDLE_LOCK);
+	lockd_window_mgr_show_placeholder(lockd->lockw);
+	lockd_metrics_inc(LOCKD_CNT_PLACEHOLDER);
+	lockd_metrics_observe_since(LOCKD_HIST_PLACEHOLDER,
+				    lockd_jobs[lockd->screen].start_us);
+
 	lockd_window_mgr_ready_lock(lockd, lockd->lockw, lockd_app_create_cb,
 				    lockd_app_show_cb);
 }
 
+/* main loop : the launch has returned */
+static void _lockd_fastpath_done_cb(void *data)
+{
+	struct lockd_data *lockd = lockd_job_context(data);
+	struct lockd_fastpath_job *job;
+
+	if (lockd == NULL)
+		return;
+	job = &lockd_jobs[lockd->screen];
+
+	if (job->pid < 0) {
+		lockd_window_mgr_finish_lock(lockd->lockw);
+		lockd_suspend_release(lockd->screen);
+		__sync_lock_release(&job->busy);
+		return;
+	}
+
+	lockd->lock_app_pid = job->pid;
+	lockd->lock_start_us = job->start_us;
+
+	lockd_metrics_inc(LOCKD_CNT_LOCK);
+	lockd_persist_lock(lockd->screen, lockd->lock_app_pid);
+	lockd_boost_protect(lockd->lock_app_pid);
+	lockd_update_keys(lockd);
+	lockd_set_lock_state(VCONFKEY_IDLE_LOCK, lockd->lock_app_pid);
+
+	/* its window events may have come before its pid was known */
+	lockd_find_lock_window(lockd);
+
+	__sync_lock_release(&job->busy);
+}
+
+/* main loop : a new package, the next LCD off may take the fast path again */
+static void lockd_fastpath_refresh(struct lockd_daemon *daemon)
+{
+	char pkgname[LOCKD_PKGNAME_MAX];
+	int has_plugin;
+
+	lockd_process_mgr_copy_pkgname(pkgname, sizeof(pkgname));
+	if (strcmp(pkgname, daemon->pkgname) == 0)
+		return;
+
+	/* the next LCD off takes the main loop again, and asks again */
+	if (lockd_plugin_pending(pkgname))
+		return;
+
+	/* a name no plugin can have is launched as an app, if at all */
+	has_plugin = lockd_plugin_name_valid(pkgname)
+	    && lockd_init_plugin(daemon);
+
+	pthread_mutex_lock(&daemon->pkg_lock);
+	snprintf(daemon->pkgname, sizeof(daemon->pkgname), "%s", pkgname);
+	daemon->has_plugin = has_plugin;
+	pthread_mutex_unlock(&daemon->pkg_lock);
+
+	LOCKD_DBG("lock fast path now for %s%s", pkgname,
+		  has_plugin ? ", plugin on the main loop" : "");
+}
+
+/* main loop : everything, as without the fast path */
+static void _lockd_fastpath_full_cb(void *data)
+{
+	struct lockd_data *lockd = lockd_job_context(data);
+
+	if (lockd == NULL)
+		return;
+
+	if (!lockd->daemon->power_off) {
+		/* prepared from the old package, nobody will show it */
+		lockd_speculate_drop(lockd);
+		lockd->lock_start_us = lockd_jobs[lockd->screen].start_us;
+		lockd_launch_app_lockscreen(lockd);
+		lockd_fastpath_refresh(lockd->daemon);
+	}
+	if (lockd->lock_start_us == 0 || lockd->daemon->power_off)
+		lockd_suspend_release(lockd->screen);
+	__sync_lock_release(&lockd_jobs[lockd->screen].busy);
+}
+
+/* fast path thread : lockd_launch_app_lockscreen() up to the launch */
+static void lockd_fastpath_lock(struct lockd_data *lockd, int full)
+{
+	struct lockd_fastpath_job *job = &lockd_jobs[lockd->screen];
+	int call_state = -1;
+	int spec_pid;
+	int pid;
+	int r;
+
+	/* the last LCD off of this screen is still being handled */
+	if (!__sync_bool_compare_and_swap(&job->busy, 0, 1))
+		return;
+
+	job->start_us = lockd_metrics_now();
+	/* before anything else, the launch has to finish before a suspend */
+	lockd_suspend_block(lockd->screen);
+
+	if (full) {
+		ecore_main_loop_thread_safe_call_async(_lockd_fastpath_full_cb,
+						       lockd_job_data(lockd->
+								      screen));
+		return;
+	}
+
+	/* only the main loop writes it, a stale value costs a restart check */
+	pid = *(volatile int *)&lockd->lock_app_pid;
+	if (lockd_process_mgr_check_lock(pid) == TRUE) {
+		LOCKD_DBG("Lock Screen App is already running.");
+		r = lockd_process_mgr_restart_lock(pid, lockd->screen);
+		if (r < 0) {
+			LOCKD_DBG("Restarting Lock Screen App is fail [%d].", r);
+			usleep(LAUNCH_INTERVAL);
+		} else {
+			LOCKD_DBG("Restarting Lock Screen App, pid[%d].", r);
+			lockd_suspend_release(lockd->screen);
+			__sync_lock_release(&job->busy);
+			return;
+		}
+	}
+
+	vconf_get_int(VCONFKEY_CALL_STATE, &call_state);
+	lockd_journal_record(LOCKD_JOURNAL_CALL_STATE, call_state, 0);
+	if (call_state != VCONFKEY_CALL_OFF) {
+		LOCKD_DBG
+		    ("Current call state(%d) does not allow to launch lock screen.",
+		     call_state);
+		lockd_suspend_release(lockd->screen);
+		__sync_lock_release(&job->busy);
+		return;
+	}
+
+	spec_pid = lockd_speculate_take(lockd);
+
+	ecore_main_loop_thread_safe_call_async(_lockd_fastpath_arm_cb,
+					       lockd_job_data(lockd->screen));
+
+	lockd_metrics_observe_since(LOCKD_HIST_LCDOFF_LAUNCH, job->start_us);
+	job->pid = -1;
+	if (spec_pid > 0)
+		job->pid = lockd_speculate_show(lockd, spec_pid);
+	if (job->pid < 0)
+		job->pid = lockd_process_mgr_start_lock(lockd->screen);
+
+	ecore_main_loop_thread_safe_call_async(_lockd_fastpath_done_cb,
+					       lockd_job_data(lockd->screen));
+}
+
+static void _lockd_fastpath_state_cb(int state, void *data)
+{
+	struct lockd_daemon *daemon = (struct lockd_daemon *)data;
+	char pkgname[LOCKD_PKGNAME_MAX];
+	int full;
+	int i;
+
+	if (*(volatile int *)&daemon->power_off) {
+		LOCKD_DBG("Power off in progress, ignore PM state(%d)", state);
+		return;
+	}
+
+	/* a plugin, or a new package that may come with one : main loop */
+	lockd_process_mgr_copy_pkgname(pkgname, sizeof(pkgname));
+	pthread_mutex_lock(&daemon->pkg_lock);
+	full = daemon->has_plugin || strcmp(pkgname, daemon->pkgname) != 0;
+	pthread_mutex_unlock(&daemon->pkg_lock);
+
+	for (i = 0; i < daemon->n_lockd; i++) {
+		switch (state) {
+		case VCONFKEY_PM_STATE_LCDDIM:
+			if (!full)
+				lockd_speculate(&daemon->lockd[i]);
+			break;
+		case VCONFKEY_PM_STATE_NORMAL:
+			lockd_speculate_park(&daemon->lockd[i]);
+			break;
+		case VCONFKEY_PM_STATE_LCDOFF:
+			lockd_fastpath_lock(&daemon->lockd[i], full);
+			break;
+		}
+	}
+}
+
 static void lockd_launch_lockscreen(struct lockd_data *lockd)
 {
 	LOCKD_DBG("launch lock screen");
@@ -183,7 +927,8 @@ static void lockd_launch_lockscreen(struct lockd_data *lockd)
 
 	if (lockd_process_mgr_check_lock(lockd->lock_app_pid) == TRUE) {
 		LOCKD_DBG("Lock Screen App is already running.");
-		r = lockd_process_mgr_restart_lock();
+		r = lockd_process_mgr_restart_lock(lockd->lock_app_pid,
+						   lockd->screen);
 		if (r < 0) {
 			LOCKD_DBG("Restarting Lock Screen App is fail [%d].", r);
 		} else {
@@ -203,70 +948,420 @@ static void lockd_launch_lockscreen(struct lockd_data *lockd)
 	lockd_window_mgr_ready_lock(lockd, lockd->lockw, lockd_app_create_cb,
 				    lockd_app_show_cb);
 
-	lockd->lock_app_pid =
-	    lockd_process_mgr_start_lock(lockd, lockd_app_dead_cb);
+	lockd->lock_app_pid = lockd_process_mgr_start_lock(lockd->screen);
+	if (lockd->lock_app_pid < 0) {
+		lockd_window_mgr_finish_lock(lockd->lockw);
+		lockd->lock_app_pid = 0;
+		return;
+	}
 
-	vconf_set_int(VCONFKEY_IDLE_LOCK_STATE, VCONFKEY_IDLE_LOCK);
+	lockd_persist_lock(lockd->screen, lockd->lock_app_pid);
+	lockd_boost_protect(lockd->lock_app_pid);
+	lockd_update_keys(lockd);
+	lockd_set_lock_state(VCONFKEY_IDLE_LOCK, lockd->lock_app_pid);
 }
 
 static void lockd_unlock_lockscreen(struct lockd_data *lockd)
 {
 	LOCKD_DBG("unlock lock screen");
+	STARTER_TRACE1(unlock, lockd->screen);
+	lockd_metrics_inc(LOCKD_CNT_UNLOCK);
+	lockd_persist_unlock(lockd->screen);
+	lockd_boost_end(lockd->lock_app_pid);
+	lockd_boost_unprotect(lockd->lock_app_pid);
 	lockd->lock_app_pid = 0;
+	lockd->lock_start_us = 0;
+	lockd->visible_start_us = 0;
+	lockd_suspend_release(lockd->screen);
+
+	if (lockd->plugin != NULL) {
+		lockd_plugin_hide(lockd->plugin);
+		lockd->plugin = NULL;
+	}
 
 	lockd_window_mgr_finish_lock(lockd->lockw);
+	lockd_update_keys(lockd);
 
-	vconf_set_int(VCONFKEY_IDLE_LOCK_STATE, VCONFKEY_IDLE_UNLOCK);
+	/* the other screens still hold the lock */
+	if (lockd_any_locked(lockd->daemon))
+		return;
+
+	lockd_set_lock_state(VCONFKEY_IDLE_UNLOCK, 0);
 }
 
-static void lockd_init_vconf(struct lockd_data *lockd)
+static int _lockd_control_lock_cb(void *data)
 {
-	int val = -1;
+	struct lockd_daemon *daemon = (struct lockd_daemon *)data;
+	int i;
+
+	if (daemon->power_off)
+		return -EBUSY;
+
+	lockd_journal_record(LOCKD_JOURNAL_CONTROL, STARTER_LOCK_CONTROL_LOCK,
+			     0);
+
+	/* the fast path owns the launch and the speculative lock app */
+	if (lockd_fastpath_enabled())
+		return lockd_fastpath_lock_now() < 0 ? -EAGAIN : 0;
+
+	for (i = 0; i < daemon->n_lockd; i++)
+		lockd_lock_now(&daemon->lockd[i]);
+
+	return 0;
+}
+
+static int _lockd_control_unlock_cb(int uid, int pid, void *data)
+{
+	struct lockd_daemon *daemon = (struct lockd_daemon *)data;
+
+	/* as the lock app would by unlocking itself */
+	if (uid != 0 && lockd_find_by_pid(daemon, pid) == NULL)
+		return -EPERM;
+
+	lockd_journal_record(LOCKD_JOURNAL_CONTROL,
+			     STARTER_LOCK_CONTROL_UNLOCK, 0);
+	lockd_unlock_all(daemon);
+
+	return 0;
+}
+
+static int _lockd_control_state_cb(int *pid, void *data)
+{
+	struct lockd_daemon *daemon = (struct lockd_daemon *)data;
+	int i;
 
+	*pid = 0;
+	for (i = 0; i < daemon->n_lockd; i++) {
+		if (daemon->lockd[i].plugin != NULL) {
+			*pid = getpid();
+			return VCONFKEY_IDLE_LOCK;
+		}
+		if (daemon->lockd[i].lock_app_pid > 0) {
+			*pid = daemon->lockd[i].lock_app_pid;
+			return VCONFKEY_IDLE_LOCK;
+		}
+	}
+
+	return VCONFKEY_IDLE_UNLOCK;
+}
+
+static void _lockd_key_action_cb(enum lockd_key_action action, void *data)
+{
+	struct lockd_data *lockd = (struct lockd_data *)data;
+	char *pkgname;
+	int r;
+
+	switch (action) {
+	case LOCKD_KEY_WAKE:
+		/* a plugin's window is starter's own, nothing can cover it */
+		if (lockd->lock_app_pid <= 0)
+			break;
+		r = lockd_process_mgr_restart_lock(lockd->lock_app_pid,
+						   lockd->screen);
+		if (r < 0)
+			LOCKD_DBG("Bringing back lock app(pid : %d) is fail [%d].",
+				  lockd->lock_app_pid, r);
+		break;
+	case LOCKD_KEY_EMERGENCY:
+		pkgname = vconf_get_str(VCONF_PRIVATE_LOCKSCREEN_EMERGENCY);
+		if (pkgname != NULL && pkgname[0] != '\0') {
+			r = aul_launch_app(pkgname, NULL);
+			LOCKD_DBG("emergency app %s launched [%d]", pkgname, r);
+		}
+		free(pkgname);
+		break;
+	}
+}
+
+static const struct lockd_control_ops lockd_control_ops = {
+	.lock = _lockd_control_lock_cb,
+	.unlock = _lockd_control_unlock_cb,
+	.state = _lockd_control_state_cb,
+};
+
+static void lockd_init_vconf(struct lockd_daemon *daemon)
+{
 	if (vconf_notify_key_changed
-	    (VCONFKEY_PM_STATE, _lockd_notify_pm_state_cb, lockd) != 0) {
+	    (VCONFKEY_PM_STATE, _lockd_notify_pm_state_cb, daemon) != 0) {
 		LOCKD_ERR("Fail vconf_notify_key_changed : VCONFKEY_PM_STATE");
 	}
 
 	if (vconf_notify_key_changed
 	    (VCONFKEY_IDLE_LOCK_STATE,
 	     _lockd_notify_lock_state_cb,
-	     lockd) != 0) {
+	     daemon) != 0) {
 		LOCKD_ERR
 		    ("[Error] vconf notify : lock state");
 	}
 }
 
-static void lockd_start_lock_daemon(void *data)
+static void _lockd_noti_power_off_cb(void *data)
 {
-	struct lockd_data *lockd = NULL;
-	int r = 0;
+	struct lockd_daemon *daemon = (struct lockd_daemon *)data;
+
+	if (daemon == NULL)
+		return;
 
-	lockd = (struct lockd_data *)data;
+	lockd_journal_record(LOCKD_JOURNAL_NOTI, LOCKD_JOURNAL_NOTI_POWER_OFF, 0);
+	LOCKD_DBG("power off started, stop launching lock screen");
+	daemon->power_off = TRUE;
+}
+
+static void lockd_init_noti(struct lockd_daemon *daemon)
+{
+	if (lockd_noti_subscribe == NULL)
+		return;
+
+	if (lockd_noti_subscribe("power_off_start", _lockd_noti_power_off_cb,
+				 daemon) < 0) {
+		LOCKD_ERR("Fail to subscribe power_off_start");
+	}
+}
 
-	if (!lockd) {
+static void lockd_fini_noti(struct lockd_daemon *daemon)
+{
+	if (lockd_noti_unsubscribe == NULL)
 		return;
+
+	lockd_noti_unsubscribe("power_off_start", _lockd_noti_power_off_cb,
+			       daemon);
+}
+
+static void lockd_fini_vconf(struct lockd_daemon *daemon)
+{
+	vconf_ignore_key_changed(VCONFKEY_PM_STATE, _lockd_notify_pm_state_cb);
+	vconf_ignore_key_changed(VCONFKEY_IDLE_LOCK_STATE,
+				 _lockd_notify_lock_state_cb);
+}
+
+/* one lock context per X screen, screen 0 first */
+static int lockd_init_screens(struct lockd_daemon *daemon)
+{
+	Ecore_X_Window *roots;
+	int n = 0;
+	int i;
+
+	roots = ecore_x_window_root_list(&n);
+	if (roots == NULL || n <= 0) {
+		LOCKD_ERR("Cannot list X screens, use the first root window");
+		if (roots)
+			free(roots);
+		daemon->lockd[0].lockw =
+		    lockd_window_init(ecore_x_window_root_first_get());
+		daemon->lockd[0].daemon = daemon;
+		daemon->n_lockd = 1;
+		return 1;
 	}
 
+	if (n > LOCKD_SCREEN_MAX) {
+		LOCKD_ERR("%d X screens, lock only the first %d", n,
+			  LOCKD_SCREEN_MAX);
+		n = LOCKD_SCREEN_MAX;
+	}
+
+	for (i = 0; i < n; i++) {
+		daemon->lockd[i].daemon = daemon;
+		daemon->lockd[i].screen = i;
+		daemon->lockd[i].lockw = lockd_window_init(roots[i]);
+	}
+	daemon->n_lockd = n;
+	free(roots);
+
+	LOCKD_DBG("lock daemon manages %d screen(s)", n);
+
+	return n;
+}
+
+/* a lock plugin builds its UI now, LCD off only has to show it */
+static int lockd_init_plugin(struct lockd_daemon *daemon)
+{
+	int i;
+
+	for (i = 0; i < daemon->n_lockd; i++) {
+		if (lockd_plugin_get(lockd_process_mgr_get_pkgname(), i,
+				     _lockd_plugin_unlock_cb,
+				     &daemon->lockd[i]) == NULL)
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* a plugin is shown on the main loop anyway, there is no launch to hurry */
+static void lockd_init_fastpath(struct lockd_daemon *daemon, int has_plugin)
+{
+	memset(lockd_jobs, 0x0, sizeof(lockd_jobs));
+
+	daemon->has_plugin = has_plugin;
+	if (has_plugin)
+		return;
+
+	lockd_generation++;
+
+	lockd_process_mgr_copy_pkgname(daemon->pkgname,
+				       sizeof(daemon->pkgname));
+	lockd_fastpath_start(_lockd_fastpath_state_cb, daemon);
+}
+
+/* the window the last daemon matched, or a scan if it is not the lock app's
+ * any more */
+static void lockd_bind_lock_window(struct lockd_data *lockd, unsigned int win)
+{
+	int shown = FALSE;
+
+	if (lockd_window_mgr_bind_lock_window(lockd->lockw, win,
+					      lockd->lock_app_pid,
+					      &shown) == FALSE) {
+		lockd_find_lock_window(lockd);
+		return;
+	}
+
+	lockd_window_matched(lockd);
+	if (shown)
+		lockd_window_mgr_lock_shown(lockd->lockw);
+}
+
+/*
+ * What the last daemon left : a lock app still on screen is taken back as
+ * is, a screen that was locked without one is locked again right away.
+ */
+static void lockd_restore(struct lockd_daemon *daemon)
+{
+	struct lockd_data *lockd;
+	unsigned int win;
+	int adopted = 0;
+	int pid;
+	int i;
+
+	for (i = 0; i < daemon->n_lockd; i++) {
+		lockd = &daemon->lockd[i];
+		if (lockd_persist_restore(i, &pid, &win) != VCONFKEY_IDLE_LOCK)
+			continue;
+
+		if (pid > 0 && lockd_process_mgr_check_lock(pid) == TRUE) {
+			LOCKD_DBG("lock app(pid:%d) of screen %d taken back",
+				  pid, i);
+			lockd->lock_app_pid = pid;
+			lockd_metrics_inc(LOCKD_CNT_LOCK_ADOPT);
+			lockd_boost_protect(pid);
+			lockd_update_keys(lockd);
+			lockd_window_mgr_ready_lock(lockd, lockd->lockw,
+						    lockd_app_create_cb,
+						    lockd_app_show_cb);
+			lockd_bind_lock_window(lockd, win);
+			adopted = pid;
+			continue;
+		}
+
+		LOCKD_DBG("screen %d was locked, lock it again", i);
+		lockd->lock_start_us = lockd_metrics_now();
+		lockd_launch_app_lockscreen(lockd);
+	}
+
+	if (adopted) {
+		lockd_set_lock_state(VCONFKEY_IDLE_LOCK, adopted);
+	}
+}
+
+static void lockd_start_lock_daemon(struct lockd_daemon *daemon)
+{
+	int has_plugin;
+
 	LOCKD_DBG("%s, %d", __func__, __LINE__);
 
-	lockd_init_vconf(lockd);
+	lockd_init_screens(daemon);
+	lockd_process_mgr_init(daemon->n_lockd);
+	has_plugin = lockd_init_plugin(daemon);
+
+	lockd_init_vconf(daemon);
+	lockd_init_noti(daemon);
+	lockd_channel_init();
+	lockd_control_init(&lockd_control_ops, daemon);
+	lockd_keys_init(_lockd_key_action_cb);
+	lockd_suspend_init();
+	aul_listen_app_dead_signal(lockd_app_dead_cb, daemon);
 
-	lockd->lockw = lockd_window_init();
+	/* before the fast path thread, it would race with a relock */
+	if (lockd_persist_init() == 0)
+		lockd_restore(daemon);
+	lockd_init_fastpath(daemon, has_plugin);
 
 	LOCKD_DBG("%s, %d", __func__, __LINE__);
 }
 
+void lock_daemon_set_noti_subscriber(lock_daemon_noti_subscriber subscribe,
+				     lock_daemon_noti_subscriber unsubscribe)
+{
+	lockd_noti_subscribe = subscribe;
+	lockd_noti_unsubscribe = unsubscribe;
+}
+
 int start_lock_daemon()
 {
-	struct lockd_data *lockd = NULL;
-	int val = -1;
+	struct lockd_daemon *daemon = NULL;
 
 	LOCKD_DBG("%s, %d", __func__, __LINE__);
 
-	lockd = (struct lockd_data *)malloc(sizeof(struct lockd_data));
-	memset(lockd, 0x0, sizeof(struct lockd_data));
-	lockd_start_lock_daemon(lockd);
+	if (lockd_instance != NULL) {
+		LOCKD_DBG("lock daemon is already running");
+		return 0;
+	}
+
+	lockd_metrics_init();
+	lockd_lockstate_init();
+	lockd_wakeup_init();
+	lockd_watchdog_init();
+	lockd_journal_init();
+	lockd_boost_init();
+
+	daemon = (struct lockd_daemon *)malloc(sizeof(struct lockd_daemon));
+	if (daemon == NULL) {
+		LOCKD_ERR("Cannot allocate lock daemon");
+		return -1;
+	}
+	memset(daemon, 0x0, sizeof(struct lockd_daemon));
+	pthread_mutex_init(&daemon->pkg_lock, NULL);
+
+	lockd_start_lock_daemon(daemon);
+
+	lockd_instance = daemon;
 
 	return 0;
 }
+
+void stop_lock_daemon(void)
+{
+	struct lockd_daemon *daemon = lockd_instance;
+	int i;
+
+	if (daemon == NULL)
+		return;
+
+	LOCKD_DBG("%s, %d", __func__, __LINE__);
+
+	/* no LCD off may reach the contexts once they start going away */
+	lockd_fastpath_stop();
+	lockd_fini_vconf(daemon);
+	lockd_fini_noti(daemon);
+	aul_listen_app_dead_signal(NULL, NULL);
+	/* while the input windows are still there */
+	lockd_keys_fini();
+
+	for (i = 0; i < daemon->n_lockd; i++) {
+		lockd_speculate_drop(&daemon->lockd[i]);
+		lockd_window_mgr_finish_lock(daemon->lockd[i].lockw);
+		lockd_window_fini(daemon->lockd[i].lockw);
+	}
+	/* the record stays, the next daemon takes over from it */
+	lockd_persist_fini();
+	lockd_channel_fini();
+	lockd_control_fini();
+	lockd_suspend_fini();
+	lockd_plugin_fini();
+	lockd_process_mgr_fini();
+
+	pthread_mutex_destroy(&daemon->pkg_lock);
+	free(daemon);
+	lockd_instance = NULL;
+	lockd_generation++;
+}
@@ -0,0 +1,293 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#include "lockd-debug.h"
+#include "lockd-metrics.h"
+#include "lockd-boost.h"
+
+#define BOOST_NICE		-10
+/* below any application, above the platform daemons */
+#define BOOST_OOM_SCORE_ADJ	-500
+#define BOOST_MAX		8
+
+/* linux/ioprio.h is not exported by every toolchain */
+#define IOPRIO_CLASS_SHIFT	13
+#define IOPRIO_CLASS_BE		2
+#define IOPRIO_WHO_PROCESS	1
+#define IOPRIO_PRIO_VALUE(class, data) (((class) << IOPRIO_CLASS_SHIFT) | (data))
+
+struct boost_entry {
+	int pid;
+	int boosted;
+	uint64_t start_us;
+	int nice;
+	int ioprio;
+	int protected;
+	int oom_score_adj;
+};
+
+static struct {
+	pthread_mutex_t lock;
+	int enabled;
+	struct boost_entry entry[BOOST_MAX];
+} boost = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.enabled = 1,
+};
+
+static int _lockd_boost_ioprio_get(int pid)
+{
+#ifdef SYS_ioprio_get
+	return syscall(SYS_ioprio_get, IOPRIO_WHO_PROCESS, pid);
+#else
+	errno = ENOSYS;
+	return -1;
+#endif
+}
+
+static int _lockd_boost_ioprio_set(int pid, int ioprio)
+{
+#ifdef SYS_ioprio_set
+	return syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, pid, ioprio);
+#else
+	errno = ENOSYS;
+	return -1;
+#endif
+}
+
+static int _lockd_boost_oom_path(char *buf, int len, int pid)
+{
+	return snprintf(buf, len, "/proc/%d/oom_score_adj", pid);
+}
+
+static int _lockd_boost_oom_get(int pid, int *val)
+{
+	char path[64];
+	char buf[16];
+	ssize_t len;
+	int fd;
+
+	_lockd_boost_oom_path(path, sizeof(path), pid);
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
+	len = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+	if (len <= 0)
+		return -1;
+	buf[len] = '\0';
+	*val = atoi(buf);
+
+	return 0;
+}
+
+static int _lockd_boost_oom_set(int pid, int val)
+{
+	char path[64];
+	char buf[16];
+	int len;
+	int fd;
+	int r;
+
+	_lockd_boost_oom_path(path, sizeof(path), pid);
+	fd = open(path, O_WRONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -1;
+	len = snprintf(buf, sizeof(buf), "%d", val);
+	r = write(fd, buf, len) == len ? 0 : -1;
+	close(fd);
+
+	return r;
+}
+
+/* with boost.lock held */
+static struct boost_entry *_lockd_boost_entry(int pid, int create)
+{
+	struct boost_entry *free_entry = NULL;
+	int i;
+
+	for (i = 0; i < BOOST_MAX; i++) {
+		if (boost.entry[i].pid == pid)
+			return &boost.entry[i];
+		if (boost.entry[i].pid == 0 && free_entry == NULL)
+			free_entry = &boost.entry[i];
+	}
+
+	if (!create || free_entry == NULL)
+		return NULL;
+
+	memset(free_entry, 0x0, sizeof(*free_entry));
+	free_entry->pid = pid;
+
+	return free_entry;
+}
+
+static void _lockd_boost_release(struct boost_entry *e)
+{
+	if (!e->boosted && !e->protected)
+		e->pid = 0;
+}
+
+void lockd_boost_init(void)
+{
+	const char *env;
+
+	env = getenv("STARTER_LOCK_BOOST");
+	boost.enabled = env == NULL || atoi(env) != 0;
+	if (!boost.enabled)
+		LOCKD_DBG("lock app priority boost disabled");
+}
+
+void lockd_boost_start(int pid)
+{
+	struct boost_entry *e;
+	int nice;
+	int ioprio;
+
+	if (!boost.enabled || pid <= 0)
+		return;
+
+	pthread_mutex_lock(&boost.lock);
+	e = _lockd_boost_entry(pid, 1);
+	if (e == NULL || e->boosted) {
+		pthread_mutex_unlock(&boost.lock);
+		return;
+	}
+
+	/* PRIO_PROCESS is the main thread, the one that draws the window */
+	errno = 0;
+	nice = getpriority(PRIO_PROCESS, pid);
+	if (errno != 0) {
+		_lockd_boost_release(e);
+		pthread_mutex_unlock(&boost.lock);
+		return;
+	}
+	ioprio = _lockd_boost_ioprio_get(pid);
+
+	e->boosted = 1;
+	e->start_us = lockd_metrics_now();
+	e->nice = nice;
+	e->ioprio = ioprio;
+
+	if (nice > BOOST_NICE && setpriority(PRIO_PROCESS, pid, BOOST_NICE) < 0)
+		LOCKD_ERR("Cannot raise lock app(pid : %d) priority : %s", pid,
+			  strerror(errno));
+	if (ioprio >= 0
+	    && _lockd_boost_ioprio_set(pid,
+				       IOPRIO_PRIO_VALUE(IOPRIO_CLASS_BE,
+							 0)) < 0)
+		LOCKD_ERR("Cannot raise lock app(pid : %d) io priority : %s",
+			  pid, strerror(errno));
+	pthread_mutex_unlock(&boost.lock);
+
+	LOCKD_DBG("lock app(pid : %d) boosted, nice %d -> %d, ioprio 0x%x -> "
+		  "0x%x", pid, nice, nice > BOOST_NICE ? BOOST_NICE : nice,
+		  ioprio, IOPRIO_PRIO_VALUE(IOPRIO_CLASS_BE, 0));
+}
+
+void lockd_boost_end(int pid)
+{
+	struct boost_entry *e;
+	uint64_t start_us;
+
+	if (pid <= 0)
+		return;
+
+	pthread_mutex_lock(&boost.lock);
+	e = _lockd_boost_entry(pid, 0);
+	if (e == NULL || !e->boosted) {
+		pthread_mutex_unlock(&boost.lock);
+		return;
+	}
+
+	/* the app may have changed them itself meanwhile, ours are lost */
+	if (e->nice > BOOST_NICE)
+		setpriority(PRIO_PROCESS, pid, e->nice);
+	if (e->ioprio >= 0)
+		_lockd_boost_ioprio_set(pid, e->ioprio);
+
+	start_us = e->start_us;
+	e->boosted = 0;
+	_lockd_boost_release(e);
+	pthread_mutex_unlock(&boost.lock);
+
+	lockd_metrics_observe_since(LOCKD_HIST_BOOSTED, start_us);
+	LOCKD_DBG("lock app(pid : %d) priority restored after %llu us", pid,
+		  (unsigned long long)(lockd_metrics_now() - start_us));
+}
+
+void lockd_boost_protect(int pid)
+{
+	struct boost_entry *e;
+	int old;
+
+	if (pid <= 0 || _lockd_boost_oom_get(pid, &old) < 0)
+		return;
+
+	pthread_mutex_lock(&boost.lock);
+	e = _lockd_boost_entry(pid, 1);
+	if (e == NULL || e->protected) {
+		pthread_mutex_unlock(&boost.lock);
+		return;
+	}
+
+	if (old > BOOST_OOM_SCORE_ADJ
+	    && _lockd_boost_oom_set(pid, BOOST_OOM_SCORE_ADJ) < 0) {
+		LOCKD_ERR("Cannot protect lock app(pid : %d) : %s", pid,
+			  strerror(errno));
+		_lockd_boost_release(e);
+		pthread_mutex_unlock(&boost.lock);
+		return;
+	}
+	e->protected = 1;
+	e->oom_score_adj = old;
+	pthread_mutex_unlock(&boost.lock);
+
+	LOCKD_DBG("lock app(pid : %d) oom_score_adj %d -> %d", pid, old,
+		  old > BOOST_OOM_SCORE_ADJ ? BOOST_OOM_SCORE_ADJ : old);
+}
+
+void lockd_boost_unprotect(int pid)
+{
+	struct boost_entry *e;
+
+	if (pid <= 0)
+		return;
+
+	pthread_mutex_lock(&boost.lock);
+	e = _lockd_boost_entry(pid, 0);
+	if (e == NULL || !e->protected) {
+		pthread_mutex_unlock(&boost.lock);
+		return;
+	}
+
+	/* fails quietly once the app is gone */
+	if (e->oom_score_adj > BOOST_OOM_SCORE_ADJ)
+		_lockd_boost_oom_set(pid, e->oom_score_adj);
+	e->protected = 0;
+	_lockd_boost_release(e);
+	pthread_mutex_unlock(&boost.lock);
+}
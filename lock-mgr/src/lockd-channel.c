@@ -0,0 +1,221 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <Ecore.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "lockd-debug.h"
+#include "lockd-channel.h"
+#include "starter-lock-channel.h"
+
+/* a lock app per screen, and some room for reconnects */
+#define CHANNEL_CLIENT_MAX	16
+
+struct channel_client {
+	int fd;
+	int pid;
+	int registered;
+	Ecore_Fd_Handler *handler;
+};
+
+static struct {
+	pthread_mutex_t lock;
+	int fd;
+	Ecore_Fd_Handler *handler;
+	struct channel_client client[CHANNEL_CLIENT_MAX];
+} channel = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.fd = -1,
+};
+
+static void _lockd_channel_drop(struct channel_client *c)
+{
+	pthread_mutex_lock(&channel.lock);
+	if (c->handler)
+		ecore_main_fd_handler_del(c->handler);
+	close(c->fd);
+	memset(c, 0x0, sizeof(struct channel_client));
+	c->fd = -1;
+	pthread_mutex_unlock(&channel.lock);
+}
+
+static Eina_Bool _lockd_channel_client_cb(void *data,
+					  Ecore_Fd_Handler *fd_handler)
+{
+	struct channel_client *c = data;
+	char msg;
+	ssize_t n;
+
+	n = recv(c->fd, &msg, 1, MSG_DONTWAIT);
+	if (n < 0 && (errno == EAGAIN || errno == EINTR))
+		return ECORE_CALLBACK_RENEW;
+
+	if (n <= 0) {
+		LOCKD_DBG("relock channel of pid %d closed", c->pid);
+		c->handler = NULL;
+		_lockd_channel_drop(c);
+		return ECORE_CALLBACK_CANCEL;
+	}
+
+	if (msg == STARTER_LOCK_CHANNEL_HELLO && !c->registered) {
+		c->registered = TRUE;
+		LOCKD_DBG("pid %d is on the relock channel", c->pid);
+	}
+
+	return ECORE_CALLBACK_RENEW;
+}
+
+static Eina_Bool _lockd_channel_accept_cb(void *data,
+					  Ecore_Fd_Handler *fd_handler)
+{
+	struct channel_client *c = NULL;
+	struct ucred cred;
+	socklen_t len = sizeof(cred);
+	int fd;
+	int i;
+
+	fd = accept4(channel.fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if (fd < 0)
+		return ECORE_CALLBACK_RENEW;
+
+	/* the kernel's word on who connected, not the client's */
+	if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0) {
+		close(fd);
+		return ECORE_CALLBACK_RENEW;
+	}
+
+	for (i = 0; i < CHANNEL_CLIENT_MAX; i++) {
+		if (channel.client[i].fd < 0) {
+			c = &channel.client[i];
+			break;
+		}
+	}
+	if (c == NULL) {
+		LOCKD_ERR("relock channel is full, pid %d refused", cred.pid);
+		close(fd);
+		return ECORE_CALLBACK_RENEW;
+	}
+
+	pthread_mutex_lock(&channel.lock);
+	c->fd = fd;
+	c->pid = cred.pid;
+	c->registered = FALSE;
+	pthread_mutex_unlock(&channel.lock);
+
+	c->handler = ecore_main_fd_handler_add(fd, ECORE_FD_READ,
+					       _lockd_channel_client_cb, c,
+					       NULL, NULL);
+	if (c->handler == NULL)
+		_lockd_channel_drop(c);
+
+	return ECORE_CALLBACK_RENEW;
+}
+
+int lockd_channel_init(void)
+{
+	struct sockaddr_un addr;
+	socklen_t len;
+	int i;
+
+	if (channel.fd >= 0)
+		return 0;
+
+	for (i = 0; i < CHANNEL_CLIENT_MAX; i++)
+		channel.client[i].fd = -1;
+
+	channel.fd = socket(AF_UNIX,
+			    SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (channel.fd < 0) {
+		LOCKD_ERR("Cannot create relock channel socket");
+		return -1;
+	}
+
+	len = starter_lock_channel_addr(&addr);
+	if (bind(channel.fd, (struct sockaddr *)&addr, len) < 0
+	    || listen(channel.fd, CHANNEL_CLIENT_MAX) < 0) {
+		LOCKD_ERR("Cannot listen on the relock channel : %s",
+			  strerror(errno));
+		close(channel.fd);
+		channel.fd = -1;
+		return -1;
+	}
+
+	channel.handler = ecore_main_fd_handler_add(channel.fd, ECORE_FD_READ,
+						    _lockd_channel_accept_cb,
+						    NULL, NULL, NULL);
+	if (channel.handler == NULL) {
+		close(channel.fd);
+		channel.fd = -1;
+		return -1;
+	}
+
+	return 0;
+}
+
+int lockd_channel_relock(int pid)
+{
+	char msg = STARTER_LOCK_CHANNEL_RELOCK;
+	int r = -1;
+	int i;
+
+	if (pid <= 0)
+		return -1;
+
+	pthread_mutex_lock(&channel.lock);
+	for (i = 0; i < CHANNEL_CLIENT_MAX; i++) {
+		if (channel.client[i].fd < 0 || !channel.client[i].registered
+		    || channel.client[i].pid != pid)
+			continue;
+
+		/* a dead peer is cleaned up on the main loop, aul takes over */
+		if (send(channel.client[i].fd, &msg, 1,
+			 MSG_DONTWAIT | MSG_NOSIGNAL) == 1)
+			r = 0;
+		break;
+	}
+	pthread_mutex_unlock(&channel.lock);
+
+	return r;
+}
+
+void lockd_channel_fini(void)
+{
+	int i;
+
+	if (channel.fd < 0)
+		return;
+
+	for (i = 0; i < CHANNEL_CLIENT_MAX; i++) {
+		if (channel.client[i].fd >= 0)
+			_lockd_channel_drop(&channel.client[i]);
+	}
+
+	if (channel.handler) {
+		ecore_main_fd_handler_del(channel.handler);
+		channel.handler = NULL;
+	}
+	if (channel.fd >= 0) {
+		close(channel.fd);
+		channel.fd = -1;
+	}
+}
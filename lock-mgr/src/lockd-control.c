@@ -0,0 +1,273 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <Ecore.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "lockd-debug.h"
+#include "lockd-control.h"
+#include "lockd-metrics.h"
+#include "lockd-wakeup.h"
+#include "starter-lock-control.h"
+
+#define CONTROL_CLIENT_MAX	16
+/* apps, the owner of VCONFKEY_IDLE_LOCK_STATE (packaging/starter.spec) */
+#define CONTROL_APP_UID		5000
+
+struct control_client {
+	int fd;
+	int pid;
+	int uid;
+	int subscribed;
+	Ecore_Fd_Handler *handler;
+};
+
+static struct {
+	int fd;
+	Ecore_Fd_Handler *handler;
+	const struct lockd_control_ops *ops;
+	void *data;
+	struct control_client client[CONTROL_CLIENT_MAX];
+} control = {
+	.fd = -1,
+};
+
+static void _lockd_control_drop(struct control_client *c)
+{
+	if (c->handler)
+		ecore_main_fd_handler_del(c->handler);
+	close(c->fd);
+	memset(c, 0x0, sizeof(struct control_client));
+	c->fd = -1;
+}
+
+static int _lockd_control_send(struct control_client *c, int type, int error)
+{
+	struct starter_lock_control_msg msg;
+	int pid = 0;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.type = type;
+	msg.error = error;
+	msg.state = control.ops->state(&pid, control.data);
+	msg.pid = pid;
+
+	if (send(c->fd, &msg, sizeof(msg), MSG_DONTWAIT | MSG_NOSIGNAL)
+	    != sizeof(msg))
+		return -1;
+
+	return 0;
+}
+
+static int _lockd_control_handle(struct control_client *c, int type)
+{
+	switch (type) {
+	case STARTER_LOCK_CONTROL_LOCK:
+		if (c->uid != 0 && c->uid != CONTROL_APP_UID)
+			return -EPERM;
+		LOCKD_DBG("lock requested by pid %d", c->pid);
+		return control.ops->lock(control.data);
+	case STARTER_LOCK_CONTROL_UNLOCK:
+		LOCKD_DBG("unlock requested by pid %d", c->pid);
+		return control.ops->unlock(c->uid, c->pid, control.data);
+	case STARTER_LOCK_CONTROL_STATUS:
+		return 0;
+	case STARTER_LOCK_CONTROL_SUBSCRIBE:
+		c->subscribed = TRUE;
+		return 0;
+	}
+
+	return -EINVAL;
+}
+
+static Eina_Bool _lockd_control_client_cb(void *data,
+					  Ecore_Fd_Handler *fd_handler)
+{
+	struct control_client *c = data;
+	struct starter_lock_control_msg msg;
+	ssize_t n;
+	int error;
+
+	lockd_wakeup_source("lock control");
+
+	n = recv(c->fd, &msg, sizeof(msg), MSG_DONTWAIT);
+	if (n < 0 && (errno == EAGAIN || errno == EINTR))
+		return ECORE_CALLBACK_RENEW;
+
+	if (n <= 0) {
+		c->handler = NULL;
+		_lockd_control_drop(c);
+		return ECORE_CALLBACK_CANCEL;
+	}
+
+	lockd_metrics_inc(LOCKD_CNT_CONTROL);
+	if (n != sizeof(msg))
+		error = -EINVAL;
+	else
+		error = _lockd_control_handle(c, msg.type);
+
+	/* the request's own state change found it behind as a subscriber */
+	if (c->fd < 0)
+		return ECORE_CALLBACK_CANCEL;
+
+	if (_lockd_control_send(c, msg.type, error) < 0) {
+		LOCKD_ERR("cannot reply to lock control client pid %d",
+			  c->pid);
+		c->handler = NULL;
+		_lockd_control_drop(c);
+		return ECORE_CALLBACK_CANCEL;
+	}
+
+	return ECORE_CALLBACK_RENEW;
+}
+
+static Eina_Bool _lockd_control_accept_cb(void *data,
+					  Ecore_Fd_Handler *fd_handler)
+{
+	struct control_client *c = NULL;
+	struct ucred cred;
+	socklen_t len = sizeof(cred);
+	int fd;
+	int i;
+
+	fd = accept4(control.fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if (fd < 0)
+		return ECORE_CALLBACK_RENEW;
+
+	if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0) {
+		close(fd);
+		return ECORE_CALLBACK_RENEW;
+	}
+
+	for (i = 0; i < CONTROL_CLIENT_MAX; i++) {
+		if (control.client[i].fd < 0) {
+			c = &control.client[i];
+			break;
+		}
+	}
+	if (c == NULL) {
+		LOCKD_ERR("lock control is full, pid %d refused", cred.pid);
+		close(fd);
+		return ECORE_CALLBACK_RENEW;
+	}
+
+	c->fd = fd;
+	c->pid = cred.pid;
+	c->uid = cred.uid;
+	c->subscribed = FALSE;
+	c->handler = ecore_main_fd_handler_add(fd, ECORE_FD_READ,
+					       _lockd_control_client_cb, c,
+					       NULL, NULL);
+	if (c->handler == NULL)
+		_lockd_control_drop(c);
+
+	return ECORE_CALLBACK_RENEW;
+}
+
+int lockd_control_init(const struct lockd_control_ops *ops, void *data)
+{
+	struct sockaddr_un addr;
+	socklen_t len;
+	int i;
+
+	if (control.fd >= 0)
+		return 0;
+
+	for (i = 0; i < CONTROL_CLIENT_MAX; i++)
+		control.client[i].fd = -1;
+	control.ops = ops;
+	control.data = data;
+
+	control.fd = socket(AF_UNIX,
+			    SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (control.fd < 0) {
+		LOCKD_ERR("Cannot create lock control socket");
+		return -1;
+	}
+
+	len = starter_lock_control_addr(&addr);
+	if (bind(control.fd, (struct sockaddr *)&addr, len) < 0
+	    || listen(control.fd, CONTROL_CLIENT_MAX) < 0) {
+		LOCKD_ERR("Cannot listen on the lock control socket : %s",
+			  strerror(errno));
+		close(control.fd);
+		control.fd = -1;
+		return -1;
+	}
+
+	control.handler = ecore_main_fd_handler_add(control.fd, ECORE_FD_READ,
+						    _lockd_control_accept_cb,
+						    NULL, NULL, NULL);
+	if (control.handler == NULL) {
+		close(control.fd);
+		control.fd = -1;
+		return -1;
+	}
+
+	return 0;
+}
+
+void lockd_control_event(int state, int pid)
+{
+	struct starter_lock_control_msg msg;
+	int i;
+
+	if (control.fd < 0)
+		return;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.type = STARTER_LOCK_CONTROL_EVENT;
+	msg.state = state;
+	msg.pid = pid;
+
+	for (i = 0; i < CONTROL_CLIENT_MAX; i++) {
+		if (control.client[i].fd < 0 || !control.client[i].subscribed)
+			continue;
+
+		/* one that missed a change would go on with a wrong state */
+		if (send(control.client[i].fd, &msg, sizeof(msg),
+			 MSG_DONTWAIT | MSG_NOSIGNAL) != sizeof(msg)) {
+			LOCKD_ERR("lock control subscriber pid %d is behind, "
+				  "dropped", control.client[i].pid);
+			_lockd_control_drop(&control.client[i]);
+		}
+	}
+}
+
+void lockd_control_fini(void)
+{
+	int i;
+
+	if (control.fd < 0)
+		return;
+
+	for (i = 0; i < CONTROL_CLIENT_MAX; i++) {
+		if (control.client[i].fd >= 0)
+			_lockd_control_drop(&control.client[i]);
+	}
+
+	if (control.handler) {
+		ecore_main_fd_handler_del(control.handler);
+		control.handler = NULL;
+	}
+	close(control.fd);
+	control.fd = -1;
+}
@@ -21,6 +21,8 @@
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
 #include <glib.h>
 
 #include "lockd-debug.h"
@@ -29,17 +31,53 @@
 #define MAXFILELEN	1048576
 #define LOGFILE "/tmp/starter.log"
 
+/* kept open instead of an fopen/fclose per line, and truncated in place
+ * instead of forking rm when a write fails or the file passes MAXFILELEN.
+ * The lock fast path, watchdog and prefetch threads log too, log_fd is only
+ * used under log_lock. */
+static int log_fd = -1;
+static pthread_mutex_t log_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void _lockd_log_write(const char *line, int len)
+{
+	off_t fileLen = 0;
+
+	if (log_fd < 0) {
+		log_fd = open(LOGFILE, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+			      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+		if (log_fd < 0) {
+			STARTER_DBG("File open fail for writing Pwlock information");
+			return;
+		}
+	}
+
+	if (write(log_fd, line, len) < len) {
+		STARTER_DBG("File write fail for writing Pwlock information");
+		if (ftruncate(log_fd, 0) < 0) {
+			close(log_fd);
+			log_fd = -1;
+		}
+		return;
+	}
+
+	fileLen = lseek(log_fd, 0, SEEK_CUR);
+	if (fileLen > MAXFILELEN) {
+		if (ftruncate(log_fd, 0) < 0) {
+			close(log_fd);
+			log_fd = -1;
+		}
+	}
+}
+
 void lockd_log_t(char *fmt, ...)
 {
 	va_list ap;
-	FILE *fd = 0;
 	char buf[LINEMAX] = { 0, };
 	char debugString[LINEMAX] = { 0, };
 
 	va_start(ap, fmt);
 	vsnprintf(buf, sizeof(buf), fmt, ap);
 	va_end(ap);
-	int fileLen = 0;
 	struct tm local_t;
 	time_t current_time = 0;
 	bzero((char *)&debugString, LINEMAX);
@@ -56,37 +94,13 @@ void lockd_log_t(char *fmt, ...)
 		debugString[len] = '\0';
 	}
 	len = g_strlcat(debugString, buf, LINEMAX);
-	if (len >= LINEMAX) {
+	if (len >= LINEMAX - 1) {
 		return;
 	} else {
-		debugString[len] = '\n';
-	}
-	if ((fd = fopen(LOGFILE, "at+")) == NULL) {
-		LOCKD_DBG("File fopen fail for writing Pwlock information");
-	} else {
-		int pid = -1;
-		if (fwrite(debugString, strlen(debugString), 1, fd) < 1) {
-			LOCKD_DBG
-			    ("File fwrite fail for writing Pwlock information");
-			fclose(fd);
-			if ((pid = fork()) < 0) {
-			} else if (pid == 0) {
-				execl("/bin/rm", "rm", "-f", LOGFILE,
-				      (char *)0);
-			}
-		} else {
-			fseek(fd, 0l, SEEK_END);
-			fileLen = ftell(fd);
-			if (fileLen > MAXFILELEN) {
-				fclose(fd);
-				if ((pid = fork()) < 0) {
-					return;
-				} else if (pid == 0) {
-					execl("/bin/rm", "rm", "-f", LOGFILE,
-					      (char *)0);
-				}
-			} else
-				fclose(fd);
-		}
+		debugString[len++] = '\n';
 	}
+
+	pthread_mutex_lock(&log_lock);
+	_lockd_log_write(debugString, len);
+	pthread_mutex_unlock(&log_lock);
 }
@@ -0,0 +1,273 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <pthread.h>
+#include <sys/inotify.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <vconf.h>
+#include <vconf-keys.h>
+
+#include "lockd-debug.h"
+#include "lockd-fastpath.h"
+#include "lockd-trace.h"
+
+/* where vconf's memory backend keeps VCONFKEY_PM_STATE */
+#define FASTPATH_PM_STATE_FILE	"/var/run/memory/pm/state"
+#define FASTPATH_NICE		-10
+#define FASTPATH_STOP		-1
+#define FASTPATH_LOCK_NOW	-2
+
+static struct {
+	int enabled;
+	pthread_t tid;
+	int pipe[2];
+	int inotify_fd;
+	char pm_name[NAME_MAX + 1];
+	int last_state;
+
+	void (*state_cb) (int, void *);
+	void *data;
+} fastpath = {
+	.pipe = { -1, -1 },
+	.inotify_fd = -1,
+};
+
+static void _lockd_fastpath_observe(int val)
+{
+	int prev = fastpath.last_state;
+
+	fastpath.last_state = val;
+	if (val != prev) {
+		STARTER_TRACE1(fastpath_pm_state, val);
+		fastpath.state_cb(val, fastpath.data);
+	}
+}
+
+static int _lockd_fastpath_read_pipe(void)
+{
+	int val;
+
+	while (read(fastpath.pipe[0], &val, sizeof(val)) == sizeof(val)) {
+		if (val == FASTPATH_STOP)
+			return -1;
+		/* as LCD off, but the PM state has not changed */
+		if (val == FASTPATH_LOCK_NOW) {
+			fastpath.state_cb(VCONFKEY_PM_STATE_LCDOFF,
+					  fastpath.data);
+			continue;
+		}
+		_lockd_fastpath_observe(val);
+	}
+
+	return 0;
+}
+
+static void _lockd_fastpath_read_inotify(void)
+{
+	char buf[sizeof(struct inotify_event) + NAME_MAX + 1]
+	    __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	const struct inotify_event *ev;
+	ssize_t len;
+	char *p;
+	int changed = 0;
+	int val = -1;
+
+	while ((len = read(fastpath.inotify_fd, buf, sizeof(buf))) > 0) {
+		for (p = buf; p < buf + len;
+		     p += sizeof(struct inotify_event) + ev->len) {
+			ev = (const struct inotify_event *)p;
+			if (ev->len && strcmp(ev->name, fastpath.pm_name) == 0)
+				changed = 1;
+		}
+	}
+
+	if (changed && vconf_get_int(VCONFKEY_PM_STATE, &val) == 0)
+		_lockd_fastpath_observe(val);
+}
+
+static void *_lockd_fastpath_thread(void *data)
+{
+	struct pollfd pfd[2];
+	int n;
+
+	if (setpriority(PRIO_PROCESS, syscall(SYS_gettid), FASTPATH_NICE) < 0)
+		LOCKD_ERR("Cannot raise lock fast path priority : %s",
+			  strerror(errno));
+
+	pfd[0].fd = fastpath.pipe[0];
+	pfd[0].events = POLLIN;
+	pfd[1].fd = fastpath.inotify_fd;
+	pfd[1].events = POLLIN;
+	n = fastpath.inotify_fd >= 0 ? 2 : 1;
+
+	for (;;) {
+		if (poll(pfd, n, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			LOCKD_ERR("lock fast path poll : %s", strerror(errno));
+			break;
+		}
+
+		/* the file first : it does not wait for the main loop */
+		if (n == 2 && (pfd[1].revents & POLLIN))
+			_lockd_fastpath_read_inotify();
+		if (pfd[0].revents & POLLIN) {
+			if (_lockd_fastpath_read_pipe() < 0)
+				break;
+		}
+	}
+
+	return NULL;
+}
+
+static void _lockd_fastpath_watch(void)
+{
+	const char *file;
+	char dir[PATH_MAX];
+	char name[PATH_MAX];
+
+	file = getenv("STARTER_PM_STATE_FILE");
+	if (file == NULL || file[0] == '\0')
+		file = FASTPATH_PM_STATE_FILE;
+
+	/* vconf may replace the file, watch its directory */
+	snprintf(dir, sizeof(dir), "%s", file);
+	snprintf(name, sizeof(name), "%s", file);
+	snprintf(fastpath.pm_name, sizeof(fastpath.pm_name), "%s",
+		 basename(name));
+
+	fastpath.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fastpath.inotify_fd < 0)
+		return;
+
+	if (inotify_add_watch(fastpath.inotify_fd, dirname(dir),
+			      IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+		LOCKD_DBG("Cannot watch %s, PM state comes from the main loop",
+			  file);
+		close(fastpath.inotify_fd);
+		fastpath.inotify_fd = -1;
+	}
+}
+
+int lockd_fastpath_start(void (*state_cb) (int, void *), void *data)
+{
+	const char *env;
+	int r;
+
+	if (fastpath.enabled)
+		return 0;
+
+	env = getenv("STARTER_LOCK_FASTPATH");
+	if (env != NULL && atoi(env) == 0) {
+		LOCKD_DBG("lock fast path disabled");
+		return -1;
+	}
+
+	if (pipe2(fastpath.pipe, O_NONBLOCK | O_CLOEXEC) < 0) {
+		LOCKD_ERR("Cannot create lock fast path pipe");
+		return -1;
+	}
+
+	fastpath.state_cb = state_cb;
+	fastpath.data = data;
+	if (vconf_get_int(VCONFKEY_PM_STATE, &fastpath.last_state) < 0)
+		fastpath.last_state = -1;
+
+	_lockd_fastpath_watch();
+
+	r = pthread_create(&fastpath.tid, NULL, _lockd_fastpath_thread, NULL);
+	if (r != 0) {
+		LOCKD_ERR("Cannot start lock fast path thread (%d)", r);
+		lockd_fastpath_stop();
+		return -1;
+	}
+	fastpath.enabled = 1;
+
+	LOCKD_DBG("lock fast path started%s",
+		  fastpath.inotify_fd >= 0 ? ", watching PM state" : "");
+
+	return 0;
+}
+
+int lockd_fastpath_enabled(void)
+{
+	return fastpath.enabled;
+}
+
+void lockd_fastpath_pm_state(int val)
+{
+	if (!fastpath.enabled)
+		return;
+
+	if (write(fastpath.pipe[1], &val, sizeof(val)) != sizeof(val))
+		LOCKD_ERR("lock fast path pipe is full");
+}
+
+int lockd_fastpath_lock_now(void)
+{
+	int val = FASTPATH_LOCK_NOW;
+
+	if (!fastpath.enabled)
+		return -1;
+
+	if (write(fastpath.pipe[1], &val, sizeof(val)) != sizeof(val)) {
+		LOCKD_ERR("lock fast path pipe is full");
+		return -1;
+	}
+
+	return 0;
+}
+
+void lockd_fastpath_stop(void)
+{
+	struct pollfd pfd;
+	int val = FASTPATH_STOP;
+
+	if (fastpath.enabled) {
+		/* the pipe may be full of PM states, the thread drains it :
+		 * without STOP in it the join below would never return */
+		pfd.fd = fastpath.pipe[1];
+		pfd.events = POLLOUT;
+		while (write(fastpath.pipe[1], &val, sizeof(val)) < 0) {
+			if (errno == EAGAIN)
+				poll(&pfd, 1, -1);
+			else if (errno != EINTR)
+				break;
+		}
+		pthread_join(fastpath.tid, NULL);
+		fastpath.enabled = 0;
+	}
+
+	if (fastpath.inotify_fd >= 0)
+		close(fastpath.inotify_fd);
+	if (fastpath.pipe[0] >= 0)
+		close(fastpath.pipe[0]);
+	if (fastpath.pipe[1] >= 0)
+		close(fastpath.pipe[1]);
+
+	fastpath.inotify_fd = -1;
+	fastpath.pipe[0] = fastpath.pipe[1] = -1;
+}
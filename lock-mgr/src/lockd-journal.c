@@ -0,0 +1,112 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "lockd-debug.h"
+#include "lockd-journal.h"
+
+/* records come from the main loop and the lock fast path thread : a write
+ * failure closes journal_fd, another record must not go to the fd number
+ * that is reused next. Written under journal_lock. */
+static int journal_fd = -1;
+static pthread_mutex_t journal_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t journal_start_ns;
+
+static uint64_t _lockd_journal_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+int lockd_journal_init(void)
+{
+	struct lockd_journal_header hdr;
+	const char *path;
+
+	if (journal_fd != -1)
+		return 0;
+
+	path = getenv("STARTER_JOURNAL");
+	if (path == NULL || path[0] == '\0')
+		return 0;
+
+	journal_fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+			  S_IRUSR | S_IWUSR | S_IRGRP);
+	if (journal_fd < 0) {
+		LOCKD_ERR("Cannot open journal %s", path);
+		return -1;
+	}
+
+	journal_start_ns = _lockd_journal_now();
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = LOCKD_JOURNAL_MAGIC;
+	hdr.version = LOCKD_JOURNAL_VERSION;
+	hdr.start_ns = journal_start_ns;
+	if (write(journal_fd, &hdr, sizeof(hdr)) != sizeof(hdr)) {
+		LOCKD_ERR("Cannot write journal header");
+		close(journal_fd);
+		journal_fd = -1;
+		return -1;
+	}
+
+	LOCKD_DBG("journal recording to %s", path);
+
+	return 0;
+}
+
+int lockd_journal_enabled(void)
+{
+	return journal_fd != -1;
+}
+
+void lockd_journal_record(enum lockd_journal_type type, int arg0, int arg1)
+{
+	struct lockd_journal_record rec;
+
+	/* not recording, as on any device : no lock taken */
+	if (journal_fd == -1)
+		return;
+
+	pthread_mutex_lock(&journal_lock);
+	if (journal_fd == -1) {
+		pthread_mutex_unlock(&journal_lock);
+		return;
+	}
+
+	memset(&rec, 0, sizeof(rec));
+	rec.ts_ns = _lockd_journal_now() - journal_start_ns;
+	rec.type = type;
+	rec.arg[0] = arg0;
+	rec.arg[1] = arg1;
+
+	if (write(journal_fd, &rec, sizeof(rec)) != sizeof(rec)) {
+		LOCKD_ERR("journal write failed, stop recording");
+		close(journal_fd);
+		journal_fd = -1;
+	}
+	pthread_mutex_unlock(&journal_lock);
+}
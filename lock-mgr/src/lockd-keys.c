@@ -0,0 +1,234 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <Ecore.h>
+#include <Ecore_X.h>
+#include <Ecore_Input.h>
+#include <utilX.h>
+#include <string.h>
+
+#include "lockd-debug.h"
+#include "lockd-keys.h"
+#include "lockd-metrics.h"
+#include "lockd-wakeup.h"
+#include "lockd-journal.h"
+
+/* one input window per X screen */
+#define KEYS_WINDOW_MAX		8
+/* presses of the same key further apart start a new count */
+#define KEYS_REPEAT_MS		1000
+
+struct lockd_key {
+	const char *name;
+	int grab;
+	/* the action runs on this press in a row */
+	int presses;
+	enum lockd_key_action action;
+};
+
+/*
+ * Only the keys here are grabbed while locked, every other key goes where it
+ * would go without starter. The first entry of a key gives its grab mode.
+ */
+static const struct lockd_key lockd_key_table[] = {
+	/* home : the lock app, instead of the menu screen */
+	{ KEY_SELECT, EXCLUSIVE_GRAB, 1, LOCKD_KEY_WAKE },
+	{ KEY_SELECT, EXCLUSIVE_GRAB, 3, LOCKD_KEY_EMERGENCY },
+};
+
+#define KEYS_TABLE_SIZE	\
+	(int)(sizeof(lockd_key_table) / sizeof(lockd_key_table[0]))
+
+struct keys_window {
+	unsigned int win;
+	void *data;
+};
+
+static struct {
+	lockd_key_action_cb cb;
+	struct keys_window window[KEYS_WINDOW_MAX];
+	int n_grabbed;
+	Ecore_Event_Handler *handler;
+
+	/* the first entry of the key being pressed in a row */
+	int last;
+	unsigned int last_ms;
+	int presses;
+} keys = {
+	.last = -1,
+};
+
+static struct keys_window *_lockd_keys_find(unsigned int win)
+{
+	int i;
+
+	for (i = 0; i < KEYS_WINDOW_MAX; i++) {
+		if (keys.window[i].win == win)
+			return &keys.window[i];
+	}
+
+	return NULL;
+}
+
+/* the key's first entry in the table, -1 if it has none */
+static int _lockd_keys_first(const char *name)
+{
+	int i;
+
+	for (i = 0; i < KEYS_TABLE_SIZE; i++) {
+		if (strcmp(name, lockd_key_table[i].name) == 0)
+			return i;
+	}
+
+	return -1;
+}
+
+static void _lockd_keys_run(struct keys_window *w,
+			    enum lockd_key_action action)
+{
+	lockd_journal_record(LOCKD_JOURNAL_KEY, action, w - keys.window);
+	LOCKD_DBG("key action %d", action);
+
+	if (keys.cb)
+		keys.cb(action, w->data);
+}
+
+static Eina_Bool _lockd_keys_down_cb(void *data, int type, void *event)
+{
+	Ecore_Event_Key *ev = (Ecore_Event_Key *) event;
+	struct keys_window *w;
+	int first;
+	int i;
+
+	lockd_wakeup_source("x key down");
+
+	w = _lockd_keys_find(ev->event_window);
+	if (w == NULL || ev->keyname == NULL)
+		return ECORE_CALLBACK_PASS_ON;
+	lockd_metrics_inc(LOCKD_CNT_KEY);
+
+	first = _lockd_keys_first(ev->keyname);
+	if (first < 0)
+		return ECORE_CALLBACK_PASS_ON;
+
+	if (first == keys.last && ev->timestamp - keys.last_ms < KEYS_REPEAT_MS)
+		keys.presses++;
+	else
+		keys.presses = 1;
+	keys.last = first;
+	keys.last_ms = ev->timestamp;
+
+	for (i = first; i < KEYS_TABLE_SIZE; i++) {
+		if (strcmp(lockd_key_table[i].name, ev->keyname) != 0
+		    || lockd_key_table[i].presses != keys.presses)
+			continue;
+		/* the longest sequence of a key starts over after it */
+		if (keys.presses > 1)
+			keys.presses = 0;
+		_lockd_keys_run(w, lockd_key_table[i].action);
+		break;
+	}
+
+	return ECORE_CALLBACK_DONE;
+}
+
+static void _lockd_keys_grab_table(unsigned int win, int grab)
+{
+	Ecore_X_Display *dpy = ecore_x_display_get();
+	int i;
+
+	for (i = 0; i < KEYS_TABLE_SIZE; i++) {
+		if (_lockd_keys_first(lockd_key_table[i].name) != i)
+			continue;
+
+		if (grab)
+			utilx_grab_key(dpy, win, lockd_key_table[i].name,
+				       lockd_key_table[i].grab);
+		else
+			utilx_ungrab_key(dpy, win, lockd_key_table[i].name);
+		lockd_metrics_inc(LOCKD_CNT_KEY_GRAB);
+	}
+}
+
+void lockd_keys_init(lockd_key_action_cb cb)
+{
+	keys.cb = cb;
+}
+
+void lockd_keys_grab(unsigned int win, void *data)
+{
+	struct keys_window *w;
+
+	if (win == 0 || _lockd_keys_find(win) != NULL)
+		return;
+
+	w = _lockd_keys_find(0);
+	if (w == NULL) {
+		LOCKD_ERR("No room to grab keys on %x", win);
+		return;
+	}
+
+	_lockd_keys_grab_table(win, 1);
+	w->win = win;
+	w->data = data;
+
+	/* nothing reaches starter's key handler while no screen is locked */
+	if (keys.n_grabbed++ == 0)
+		keys.handler =
+		    ecore_event_handler_add(ECORE_EVENT_KEY_DOWN,
+					    _lockd_keys_down_cb, NULL);
+}
+
+void lockd_keys_ungrab(unsigned int win)
+{
+	struct keys_window *w;
+
+	if (win == 0)
+		return;
+
+	w = _lockd_keys_find(win);
+	if (w == NULL)
+		return;
+
+	_lockd_keys_grab_table(win, 0);
+	w->win = 0;
+	w->data = NULL;
+
+	if (--keys.n_grabbed == 0) {
+		if (keys.handler)
+			ecore_event_handler_del(keys.handler);
+		keys.handler = NULL;
+		keys.last = -1;
+		keys.presses = 0;
+	}
+}
+
+void lockd_keys_action(int n, enum lockd_key_action action)
+{
+	if (n < 0 || n >= KEYS_WINDOW_MAX || keys.window[n].win == 0)
+		return;
+
+	_lockd_keys_run(&keys.window[n], action);
+}
+
+void lockd_keys_fini(void)
+{
+	int i;
+
+	for (i = 0; i < KEYS_WINDOW_MAX; i++)
+		lockd_keys_ungrab(keys.window[i].win);
+	keys.cb = NULL;
+}
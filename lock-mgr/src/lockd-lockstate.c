@@ -0,0 +1,100 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <vconf.h>
+
+#include "lockd-debug.h"
+#include "lockd-lockstate.h"
+#include "starter-lockstate.h"
+
+static struct starter_lockstate *lockstate = NULL;
+
+static uint64_t _lockd_lockstate_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+int lockd_lockstate_init(void)
+{
+	struct starter_lockstate *ls;
+	int fd;
+
+	if (lockstate != NULL)
+		return 0;
+
+	fd = shm_open(STARTER_LOCKSTATE_SHM_NAME, O_RDWR | O_CREAT | O_TRUNC,
+		      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	if (fd < 0) {
+		LOCKD_ERR("Cannot open lock state segment");
+		return -1;
+	}
+
+	if (ftruncate(fd, sizeof(struct starter_lockstate)) < 0) {
+		LOCKD_ERR("Cannot resize lock state segment");
+		close(fd);
+		return -1;
+	}
+
+	ls = mmap(NULL, sizeof(struct starter_lockstate),
+		  PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (ls == MAP_FAILED) {
+		LOCKD_ERR("Cannot map lock state segment");
+		return -1;
+	}
+
+	ls->version = STARTER_LOCKSTATE_VERSION;
+	ls->state = VCONFKEY_IDLE_UNLOCK;
+	__sync_synchronize();
+	ls->magic = STARTER_LOCKSTATE_MAGIC;
+
+	lockstate = ls;
+
+	return 0;
+}
+
+void lockd_lockstate_publish(int state, int lock_app_pid)
+{
+	volatile struct starter_lockstate *ls = lockstate;
+
+	if (ls == NULL)
+		return;
+
+	ls->seq++;
+	__sync_synchronize();
+
+	if (state != ls->state) {
+		if (state == VCONFKEY_IDLE_LOCK)
+			ls->last_lock_ns = _lockd_lockstate_now();
+		else
+			ls->last_unlock_ns = _lockd_lockstate_now();
+	}
+	ls->state = state;
+	ls->lock_app_pid = lock_app_pid;
+
+	__sync_synchronize();
+	ls->seq++;
+}
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "lockd-debug.h"
+#include "lockd-metrics.h"
+
+static const char *counter_names[LOCKD_CNT_MAX] = {
+	[LOCKD_CNT_LOCK] = "lock",
+	[LOCKD_CNT_UNLOCK] = "unlock",
+	[LOCKD_CNT_LAUNCH] = "launch",
+	[LOCKD_CNT_LAUNCH_RETRY] = "launch_retry",
+	[LOCKD_CNT_LAUNCH_DEFAULT] = "launch_default",
+	[LOCKD_CNT_LAUNCH_FAIL] = "launch_fail",
+	[LOCKD_CNT_RESTART] = "restart_lock",
+	[LOCKD_CNT_APP_DEAD] = "app_dead",
+	[LOCKD_CNT_WIN_MATCH] = "window_match",
+	[LOCKD_CNT_PWLOCK_LAUNCH] = "pwlock_launch",
+	[LOCKD_CNT_HIB_LEAVE] = "hib_leave",
+	[LOCKD_CNT_PLACEHOLDER] = "placeholder",
+	[LOCKD_CNT_PLUGIN_LOCK] = "plugin_lock",
+	[LOCKD_CNT_RESUME_MAJFLT] = "resume_majflt",
+	[LOCKD_CNT_RELOCK_CHANNEL] = "relock_channel",
+	[LOCKD_CNT_LOOP_STALL] = "loop_stall",
+	[LOCKD_CNT_SPEC_LAUNCH] = "spec_launch",
+	[LOCKD_CNT_SPEC_HIT] = "spec_hit",
+	[LOCKD_CNT_SPEC_CANCEL] = "spec_cancel",
+	[LOCKD_CNT_LOCK_ADOPT] = "lock_adopt",
+	[LOCKD_CNT_BOOT_MAJFLT] = "boot_majflt",
+	[LOCKD_CNT_CONTROL] = "control_request",
+	[LOCKD_CNT_KEY] = "key_down",
+	[LOCKD_CNT_KEY_GRAB] = "key_grab",
+	[LOCKD_CNT_SUSPEND_BLOCK] = "suspend_block",
+	[LOCKD_CNT_SUSPEND_TIMEOUT] = "suspend_timeout",
+	[LOCKD_CNT_VISIBLE_NO_DAMAGE] = "visible_no_damage",
+};
+
+static const char *hist_names[LOCKD_HIST_MAX] = {
+	[LOCKD_HIST_LOCK_LATENCY] = "lock_latency",
+	[LOCKD_HIST_LAUNCH] = "aul_launch",
+	[LOCKD_HIST_WIN_MATCH] = "window_match",
+	[LOCKD_HIST_PWLOCK_LAUNCH] = "pwlock_launch",
+	[LOCKD_HIST_BOOT_INIT] = "boot_init",
+	[LOCKD_HIST_SHUTDOWN] = "shutdown",
+	[LOCKD_HIST_PLACEHOLDER] = "placeholder_map",
+	[LOCKD_HIST_LCDOFF_LAUNCH] = "lcdoff_launch",
+	[LOCKD_HIST_LOOP_ITER] = "loop_iteration",
+	[LOCKD_HIST_BOOSTED] = "boosted_launch",
+	[LOCKD_HIST_SUSPEND_BLOCK] = "suspend_block",
+	[LOCKD_HIST_LOCK_VISIBLE] = "lock_visible",
+};
+
+/* used until the shared page is mapped, or if mapping fails */
+static struct lockd_metrics_page metrics_local;
+static struct lockd_metrics_page *metrics = &metrics_local;
+
+uint64_t lockd_metrics_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void _lockd_metrics_page_init(struct lockd_metrics_page *page)
+{
+	int i;
+
+	page->version = LOCKD_METRICS_VERSION;
+	page->n_counters = LOCKD_CNT_MAX;
+	page->n_hists = LOCKD_HIST_MAX;
+	page->n_buckets = LOCKD_METRICS_HIST_BUCKETS;
+	page->bucket_base_us = LOCKD_METRICS_BUCKET_BASE_US;
+	page->start_us = lockd_metrics_now();
+
+	for (i = 0; i < LOCKD_CNT_MAX; i++)
+		snprintf(page->counter[i].name, LOCKD_METRICS_NAME_MAX, "%s",
+			 counter_names[i]);
+	for (i = 0; i < LOCKD_HIST_MAX; i++)
+		snprintf(page->hist[i].name, LOCKD_METRICS_NAME_MAX, "%s",
+			 hist_names[i]);
+
+	/* readers check magic last */
+	__sync_synchronize();
+	page->magic = LOCKD_METRICS_MAGIC;
+}
+
+int lockd_metrics_init(void)
+{
+	struct lockd_metrics_page *page;
+	int fd;
+	int i;
+
+	if (metrics != &metrics_local)
+		return 0;
+
+	if (metrics_local.magic != LOCKD_METRICS_MAGIC)
+		_lockd_metrics_page_init(&metrics_local);
+
+	fd = shm_open(LOCKD_METRICS_SHM_NAME, O_RDWR | O_CREAT | O_TRUNC,
+		      S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+	if (fd < 0) {
+		LOCKD_ERR("Cannot open metrics page, keep metrics local");
+		return -1;
+	}
+
+	if (ftruncate(fd, sizeof(struct lockd_metrics_page)) < 0) {
+		LOCKD_ERR("Cannot resize metrics page");
+		close(fd);
+		return -1;
+	}
+
+	page = mmap(NULL, sizeof(struct lockd_metrics_page),
+		    PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (page == MAP_FAILED) {
+		LOCKD_ERR("Cannot map metrics page");
+		return -1;
+	}
+
+	/* carry over whatever was counted before the page existed */
+	_lockd_metrics_page_init(page);
+	page->start_us = metrics_local.start_us;
+	for (i = 0; i < LOCKD_CNT_MAX; i++)
+		page->counter[i].value = metrics_local.counter[i].value;
+	for (i = 0; i < LOCKD_HIST_MAX; i++)
+		memcpy(&page->hist[i], &metrics_local.hist[i],
+		       sizeof(struct lockd_metrics_hist));
+
+	metrics = page;
+	LOCKD_DBG("metrics page %s mapped", LOCKD_METRICS_SHM_NAME);
+
+	return 0;
+}
+
+const struct lockd_metrics_page *lockd_metrics_get(void)
+{
+	return metrics;
+}
+
+void lockd_metrics_inc(enum lockd_metrics_counter_id id)
+{
+	if (id >= LOCKD_CNT_MAX)
+		return;
+
+	__sync_fetch_and_add(&metrics->counter[id].value, 1);
+}
+
+void lockd_metrics_add(enum lockd_metrics_counter_id id, uint64_t n)
+{
+	if (id >= LOCKD_CNT_MAX)
+		return;
+
+	__sync_fetch_and_add(&metrics->counter[id].value, n);
+}
+
+void lockd_metrics_observe(enum lockd_metrics_hist_id id, uint64_t usec)
+{
+	struct lockd_metrics_hist *h;
+	uint64_t max;
+	int i;
+
+	if (id >= LOCKD_HIST_MAX)
+		return;
+
+	h = &metrics->hist[id];
+
+	for (i = 0; i < LOCKD_METRICS_HIST_BUCKETS - 1; i++) {
+		if (usec < ((uint64_t)LOCKD_METRICS_BUCKET_BASE_US << i))
+			break;
+	}
+
+	__sync_fetch_and_add(&h->bucket[i], 1);
+	__sync_fetch_and_add(&h->sum_us, usec);
+	__sync_fetch_and_add(&h->count, 1);
+
+	max = h->max_us;
+	while (usec > max) {
+		if (__sync_bool_compare_and_swap(&h->max_us, max, usec))
+			break;
+		max = h->max_us;
+	}
+}
+
+void lockd_metrics_observe_since(enum lockd_metrics_hist_id id,
+				 uint64_t start_us)
+{
+	uint64_t now;
+
+	if (start_us == 0)
+		return;
+
+	now = lockd_metrics_now();
+	if (now < start_us)
+		return;
+
+	lockd_metrics_observe(id, now - start_us);
+}
@@ -0,0 +1,266 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <vconf.h>
+#include <vconf-keys.h>
+
+#include "lockd-debug.h"
+#include "lockd-persist.h"
+#include "lockd-process-mgr.h"
+
+#define PERSIST_FILE		"/run/starter-lockd.state"
+#define PERSIST_MAGIC		0x4c4b5053
+#define PERSIST_VERSION		1
+#define PERSIST_SCREEN_MAX	8
+#define PERSIST_PKGNAME_MAX	128
+
+struct persist_screen {
+	int32_t state;
+	int32_t pid;
+	uint64_t start_time;	/* of pid, in clock ticks since boot */
+	uint32_t window;
+	uint32_t reserved;
+};
+
+struct persist_record {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t seq;
+	struct persist_screen screen[PERSIST_SCREEN_MAX];
+	char pkgname[PERSIST_PKGNAME_MAX];
+	uint32_t sum;		/* of everything above */
+	uint32_t reserved;
+};
+
+static struct {
+	struct persist_record *file;	/* two records, mapped */
+	struct persist_record cur;	/* the last one written or loaded */
+} persist;
+
+static uint32_t _lockd_persist_sum(const struct persist_record *r)
+{
+	const unsigned char *p = (const unsigned char *)r;
+	uint32_t h = 2166136261u;
+	size_t i;
+
+	for (i = 0; i < offsetof(struct persist_record, sum); i++) {
+		h ^= p[i];
+		h *= 16777619u;
+	}
+
+	return h;
+}
+
+static int _lockd_persist_valid(const struct persist_record *r)
+{
+	return r->magic == PERSIST_MAGIC && r->version == PERSIST_VERSION
+	    && r->sum == _lockd_persist_sum(r);
+}
+
+/* field 22 of /proc/<pid>/stat, 0 if the process is gone */
+static uint64_t _lockd_persist_start_time(int pid)
+{
+	char path[32];
+	char buf[512];
+	unsigned long long t;
+	ssize_t len;
+	char *p;
+	int fd;
+	int i;
+
+	snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return 0;
+	len = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+	if (len <= 0)
+		return 0;
+	buf[len] = '\0';
+
+	/* the command name may hold spaces and parentheses */
+	p = strrchr(buf, ')');
+	if (p == NULL)
+		return 0;
+
+	/* p is at the end of field 2, step to the space before field 22 */
+	for (i = 2; i < 22 && p != NULL; i++)
+		p = strchr(p + 1, ' ');
+	if (p == NULL || sscanf(p + 1, "%llu", &t) != 1)
+		return 0;
+
+	return t;
+}
+
+static void _lockd_persist_commit(void)
+{
+	if (persist.file == NULL)
+		return;
+
+	persist.cur.seq++;
+	persist.cur.sum = _lockd_persist_sum(&persist.cur);
+
+	/* the other record keeps seq - 1 until this one is complete */
+	memcpy(&persist.file[persist.cur.seq & 1], &persist.cur,
+	       sizeof(persist.cur));
+}
+
+int lockd_persist_init(void)
+{
+	struct persist_record *file;
+	const char *path;
+	int fd;
+
+	if (persist.file != NULL)
+		return 0;
+
+	path = getenv("STARTER_LOCK_PERSIST");
+	if (path == NULL)
+		path = PERSIST_FILE;
+	if (path[0] == '\0')
+		return -1;
+
+	fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+	if (fd < 0) {
+		LOCKD_ERR("Cannot open %s", path);
+		return -1;
+	}
+
+	if (ftruncate(fd, 2 * sizeof(struct persist_record)) < 0) {
+		LOCKD_ERR("Cannot resize %s", path);
+		close(fd);
+		return -1;
+	}
+
+	file = mmap(NULL, 2 * sizeof(struct persist_record),
+		    PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (file == MAP_FAILED) {
+		LOCKD_ERR("Cannot map %s", path);
+		return -1;
+	}
+
+	if (_lockd_persist_valid(&file[0])
+	    && (!_lockd_persist_valid(&file[1]) || file[0].seq > file[1].seq))
+		memcpy(&persist.cur, &file[0], sizeof(persist.cur));
+	else if (_lockd_persist_valid(&file[1]))
+		memcpy(&persist.cur, &file[1], sizeof(persist.cur));
+	else {
+		LOCKD_DBG("No lock state to restore in %s", path);
+		memset(&persist.cur, 0x0, sizeof(persist.cur));
+		persist.cur.magic = PERSIST_MAGIC;
+		persist.cur.version = PERSIST_VERSION;
+	}
+
+	persist.file = file;
+
+	return 0;
+}
+
+int lockd_persist_restore(int screen, int *pid, unsigned int *window)
+{
+	struct persist_screen *s;
+	char pkgname[PERSIST_PKGNAME_MAX];
+
+	*pid = 0;
+	*window = 0;
+	if (persist.file == NULL || screen < 0 || screen >= PERSIST_SCREEN_MAX)
+		return VCONFKEY_IDLE_UNLOCK;
+
+	s = &persist.cur.screen[screen];
+	if (s->state != VCONFKEY_IDLE_LOCK)
+		return VCONFKEY_IDLE_UNLOCK;
+
+	/* the pid may have been reused, or the package changed meanwhile */
+	lockd_process_mgr_copy_pkgname(pkgname, sizeof(pkgname));
+	if (s->pid > 0 && s->start_time != 0
+	    && _lockd_persist_start_time(s->pid) == s->start_time
+	    && strncmp(pkgname, persist.cur.pkgname, sizeof(pkgname)) == 0) {
+		*pid = s->pid;
+		*window = s->window;
+	}
+
+	LOCKD_DBG("screen %d was locked by pid %d (window 0x%x), %s", screen,
+		  s->pid, s->window, *pid ? "still there" : "gone");
+
+	return VCONFKEY_IDLE_LOCK;
+}
+
+void lockd_persist_lock(int screen, int pid)
+{
+	struct persist_screen *s;
+
+	if (persist.file == NULL || screen < 0 || screen >= PERSIST_SCREEN_MAX)
+		return;
+
+	s = &persist.cur.screen[screen];
+	s->state = VCONFKEY_IDLE_LOCK;
+	s->pid = pid;
+	s->start_time = pid > 0 ? _lockd_persist_start_time(pid) : 0;
+	lockd_process_mgr_copy_pkgname(persist.cur.pkgname,
+				       sizeof(persist.cur.pkgname));
+
+	_lockd_persist_commit();
+}
+
+void lockd_persist_window(int screen, unsigned int window)
+{
+	struct persist_screen *s;
+
+	if (persist.file == NULL || screen < 0 || screen >= PERSIST_SCREEN_MAX)
+		return;
+
+	s = &persist.cur.screen[screen];
+	if (s->window == window)
+		return;
+	s->window = window;
+
+	_lockd_persist_commit();
+}
+
+void lockd_persist_unlock(int screen)
+{
+	struct persist_screen *s;
+
+	if (persist.file == NULL || screen < 0 || screen >= PERSIST_SCREEN_MAX)
+		return;
+
+	s = &persist.cur.screen[screen];
+	if (s->state != VCONFKEY_IDLE_LOCK)
+		return;
+	memset(s, 0x0, sizeof(*s));
+	s->state = VCONFKEY_IDLE_UNLOCK;
+
+	_lockd_persist_commit();
+}
+
+void lockd_persist_fini(void)
+{
+	if (persist.file == NULL)
+		return;
+
+	munmap(persist.file, 2 * sizeof(struct persist_record));
+	persist.file = NULL;
+}
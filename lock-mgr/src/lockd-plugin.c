@@ -0,0 +1,224 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <unistd.h>
+#include <dlfcn.h>
+
+#include "lockd-debug.h"
+#include "lockd-plugin.h"
+#include "starter-lock-plugin.h"
+
+#define PLUGIN_PKGNAME_MAX	128
+#define PLUGIN_SCREEN_MAX	8
+
+struct _lockd_plugin {
+	struct starter_lock_plugin_host host;
+	void *priv;
+	int shown;
+};
+
+/*
+ * One plugin library at a time : the one of the configured lock screen
+ * package. A package without a plugin is remembered too, so LCD off does
+ * not look for the file again until the package changes. The library of an
+ * old package stays while one of its instances is shown, the screen it
+ * locks would have nothing to unlock it otherwise.
+ */
+static struct {
+	char pkgname[PLUGIN_PKGNAME_MAX];
+	int checked;
+	void *dl;
+	const struct starter_lock_plugin *ops;
+	lockd_plugin inst[PLUGIN_SCREEN_MAX];
+} plugin;
+
+static int _lockd_plugin_shown(void)
+{
+	int i;
+
+	for (i = 0; i < PLUGIN_SCREEN_MAX; i++) {
+		if (plugin.inst[i].priv != NULL && plugin.inst[i].shown)
+			return 1;
+	}
+
+	return 0;
+}
+
+static void _lockd_plugin_unload(void)
+{
+	int i;
+
+	for (i = 0; i < PLUGIN_SCREEN_MAX; i++) {
+		if (plugin.inst[i].priv == NULL)
+			continue;
+		if (plugin.inst[i].shown)
+			plugin.ops->hide(plugin.inst[i].priv);
+		plugin.ops->destroy(plugin.inst[i].priv);
+	}
+	memset(plugin.inst, 0x0, sizeof(plugin.inst));
+
+	/* destroy has released everything the plugin put on the main loop */
+	if (plugin.dl)
+		dlclose(plugin.dl);
+
+	plugin.dl = NULL;
+	plugin.ops = NULL;
+	plugin.checked = 0;
+	plugin.pkgname[0] = '\0';
+}
+
+/*
+ * The package name comes from a key apps can write and ends up in a path
+ * root dlopen()s : a plain file name in STARTER_LOCK_PLUGIN_DIR or nothing.
+ */
+int lockd_plugin_name_valid(const char *pkgname)
+{
+	const char *c;
+
+	if (pkgname == NULL || pkgname[0] == '\0' || pkgname[0] == '.'
+	    || strlen(pkgname) >= PLUGIN_PKGNAME_MAX
+	    || strstr(pkgname, "..") != NULL)
+		return 0;
+
+	for (c = pkgname; *c != '\0'; c++) {
+		if (!isalnum((unsigned char)*c) && *c != '.' && *c != '_'
+		    && *c != '-')
+			return 0;
+	}
+
+	return 1;
+}
+
+static void _lockd_plugin_load(const char *pkgname)
+{
+	const struct starter_lock_plugin *ops;
+	char path[PATH_MAX];
+	void *dl;
+
+	snprintf(plugin.pkgname, sizeof(plugin.pkgname), "%s", pkgname);
+	plugin.checked = 1;
+
+	snprintf(path, sizeof(path), "%s/%s.so", STARTER_LOCK_PLUGIN_DIR,
+		 pkgname);
+	if (access(path, R_OK) != 0) {
+		LOCKD_DBG("no lock plugin for %s", pkgname);
+		return;
+	}
+
+	dl = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+	if (dl == NULL) {
+		LOCKD_ERR("Cannot load lock plugin %s : %s", path, dlerror());
+		return;
+	}
+
+	ops = dlsym(dl, STARTER_LOCK_PLUGIN_SYMBOL);
+	if (ops == NULL
+	    || ops->abi_version != STARTER_LOCK_PLUGIN_ABI_VERSION
+	    || ops->create == NULL || ops->show == NULL
+	    || ops->hide == NULL || ops->destroy == NULL) {
+		LOCKD_ERR("%s is not a lock plugin (abi %d)", path,
+			  ops ? ops->abi_version : -1);
+		dlclose(dl);
+		return;
+	}
+
+	plugin.dl = dl;
+	plugin.ops = ops;
+	LOCKD_DBG("lock plugin %s loaded", path);
+}
+
+lockd_plugin *lockd_plugin_get(const char *pkgname, int screen,
+			       void (*unlock_cb) (void *), void *data)
+{
+	lockd_plugin *inst;
+
+	if (pkgname == NULL || screen < 0 || screen >= PLUGIN_SCREEN_MAX)
+		return NULL;
+
+	if (!lockd_plugin_name_valid(pkgname)) {
+		LOCKD_ERR("no lock plugin for a package named %s", pkgname);
+		return NULL;
+	}
+
+	if (lockd_plugin_pending(pkgname))
+		return NULL;
+
+	if (!plugin.checked || strcmp(plugin.pkgname, pkgname) != 0) {
+		_lockd_plugin_unload();
+		_lockd_plugin_load(pkgname);
+	}
+
+	if (plugin.ops == NULL)
+		return NULL;
+
+	inst = &plugin.inst[screen];
+	if (inst->priv != NULL)
+		return inst;
+
+	inst->host.unlock = unlock_cb;
+	inst->host.data = data;
+	inst->priv = plugin.ops->create(&inst->host, screen);
+	if (inst->priv == NULL) {
+		LOCKD_ERR("lock plugin of %s failed to create screen %d",
+			  pkgname, screen);
+		return NULL;
+	}
+
+	return inst;
+}
+
+int lockd_plugin_pending(const char *pkgname)
+{
+	if (!plugin.checked || strcmp(plugin.pkgname, pkgname) == 0)
+		return 0;
+
+	return _lockd_plugin_shown();
+}
+
+unsigned int lockd_plugin_show(lockd_plugin * inst)
+{
+	unsigned int win;
+
+	if (inst == NULL || inst->priv == NULL)
+		return 0;
+
+	win = plugin.ops->show(inst->priv);
+	if (win == 0) {
+		LOCKD_ERR("lock plugin failed to show");
+		return 0;
+	}
+	inst->shown = 1;
+
+	return win;
+}
+
+void lockd_plugin_hide(lockd_plugin * inst)
+{
+	if (inst == NULL || inst->priv == NULL || !inst->shown)
+		return;
+
+	inst->shown = 0;
+	plugin.ops->hide(inst->priv);
+}
+
+void lockd_plugin_fini(void)
+{
+	_lockd_plugin_unload();
+}
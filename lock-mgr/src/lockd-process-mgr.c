@@ -14,99 +14,269 @@
  * limitations under the License.
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <vconf.h>
 #include <vconf-keys.h>
 
 #include <aul.h>
 
 #include "lockd-debug.h"
+#include "lockd-metrics.h"
+#include "lockd-journal.h"
 #include "lockd-process-mgr.h"
+#include "lockd-channel.h"
+#include "lockd-trace.h"
+#include "lockd-boost.h"
 #include "starter-vconf.h"
 
 #define LOCKD_DEFAULT_PKG_NAME "org.tizen.draglock"
 #define LOCKD_DEFAULT_LOCKSCREEN "org.tizen.draglock"
 #define RETRY_MAXCOUNT 30
 #define RELAUNCH_INTERVAL 100*1000
+#define PKGNAME_MAX 128
+#define LAUNCH_SCREEN_MAX 8
 
-static char *_lockd_process_mgr_get_pkgname(void)
-{
-	char *pkgname = NULL;
+/*
+ * Everything a launch needs is built once and reused, so LCD off does not
+ * allocate. It is rebuilt only when the lock screen package changes.
+ * Each X screen has its own bundles, the lock app reads "screen" from them,
+ * one to show the lock screen and one to start it hidden on LCD dim.
+ * Launches may come from the lock fast path thread, the pkgname is changed
+ * on the main loop, so it is only read under the lock.
+ */
+static struct {
+	pthread_mutex_t lock;
+	char pkgname[PKGNAME_MAX];
+	bundle *b[LAUNCH_SCREEN_MAX];
+	bundle *prepare[LAUNCH_SCREEN_MAX];
+} launch_ctx = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
 
-	pkgname = vconf_get_str(VCONF_PRIVATE_LOCKSCREEN_PKGNAME);
+static void _lockd_process_mgr_set_pkgname(const char *pkgname)
+{
+	if (pkgname == NULL || pkgname[0] == '\0')
+		pkgname = LOCKD_DEFAULT_PKG_NAME;
 
+	pthread_mutex_lock(&launch_ctx.lock);
+	snprintf(launch_ctx.pkgname, sizeof(launch_ctx.pkgname), "%s",
+		 pkgname);
+	pthread_mutex_unlock(&launch_ctx.lock);
 	LOCKD_DBG("pkg name is %s", pkgname);
+}
+
+static void _lockd_process_mgr_pkgname_changed_cb(keynode_t * node,
+						  void *data)
+{
+	/* the node owns the string, nothing to free */
+	_lockd_process_mgr_set_pkgname(vconf_keynode_get_str(node));
+}
+
+static bundle *_lockd_process_mgr_make_bundle(bundle **slot,
+					      const char *mode, int screen)
+{
+	char buf[16];
+	bundle *b;
 
-	if (pkgname == NULL) {
-		return LOCKD_DEFAULT_PKG_NAME;
+	if (screen < 0 || screen >= LAUNCH_SCREEN_MAX)
+		screen = 0;
+
+	if (slot[screen] != NULL)
+		return slot[screen];
+
+	b = bundle_create();
+	if (b == NULL) {
+		LOCKD_ERR("Cannot create launch bundle");
+		return NULL;
+	}
+	bundle_add(b, "mode", mode);
+	snprintf(buf, sizeof(buf), "%d", screen);
+	bundle_add(b, "screen", buf);
+
+	slot[screen] = b;
+
+	return b;
+}
+
+static bundle *_lockd_process_mgr_get_bundle(int screen)
+{
+	return _lockd_process_mgr_make_bundle(launch_ctx.b, "normal", screen);
+}
+
+static bundle *_lockd_process_mgr_get_prepare_bundle(int screen)
+{
+	return _lockd_process_mgr_make_bundle(launch_ctx.prepare, "prepare",
+					      screen);
+}
+
+void lockd_process_mgr_init(int n_screens)
+{
+	int i;
+
+	char *vstr = NULL;
+
+	vstr = vconf_get_str(VCONF_PRIVATE_LOCKSCREEN_PKGNAME);
+	_lockd_process_mgr_set_pkgname(vstr);
+	if (vstr)
+		free(vstr);
+
+	if (n_screens > LAUNCH_SCREEN_MAX)
+		n_screens = LAUNCH_SCREEN_MAX;
+	for (i = 0; i < n_screens; i++) {
+		_lockd_process_mgr_get_bundle(i);
+		_lockd_process_mgr_get_prepare_bundle(i);
+	}
+
+	if (vconf_notify_key_changed(VCONF_PRIVATE_LOCKSCREEN_PKGNAME,
+				     _lockd_process_mgr_pkgname_changed_cb,
+				     NULL) != 0) {
+		LOCKD_ERR("Fail vconf_notify_key_changed : lock screen pkgname");
+	}
+}
+
+void lockd_process_mgr_fini(void)
+{
+	int i;
+
+	vconf_ignore_key_changed(VCONF_PRIVATE_LOCKSCREEN_PKGNAME,
+				 _lockd_process_mgr_pkgname_changed_cb);
+
+	for (i = 0; i < LAUNCH_SCREEN_MAX; i++) {
+		if (launch_ctx.b[i]) {
+			bundle_free(launch_ctx.b[i]);
+			launch_ctx.b[i] = NULL;
+		}
+		if (launch_ctx.prepare[i]) {
+			bundle_free(launch_ctx.prepare[i]);
+			launch_ctx.prepare[i] = NULL;
+		}
 	}
+	pthread_mutex_lock(&launch_ctx.lock);
+	launch_ctx.pkgname[0] = '\0';
+	pthread_mutex_unlock(&launch_ctx.lock);
+}
+
+static const char *_lockd_process_mgr_get_pkgname(void)
+{
+	if (launch_ctx.pkgname[0] == '\0')
+		_lockd_process_mgr_set_pkgname(NULL);
+
+	return launch_ctx.pkgname;
+}
 
-	return pkgname;
+/* main loop only, it is the only writer */
+const char *lockd_process_mgr_get_pkgname(void)
+{
+	return _lockd_process_mgr_get_pkgname();
+}
+
+void lockd_process_mgr_copy_pkgname(char *buf, int len)
+{
+	pthread_mutex_lock(&launch_ctx.lock);
+	snprintf(buf, len, "%s", launch_ctx.pkgname[0] ?
+		 launch_ctx.pkgname : LOCKD_DEFAULT_PKG_NAME);
+	pthread_mutex_unlock(&launch_ctx.lock);
 }
 
-int lockd_process_mgr_restart_lock(void)
+static int _lockd_process_mgr_launch(const char *pkgname, bundle *b)
 {
-	char *lock_app_path = NULL;
+	uint64_t start_us;
 	int pid;
-	bundle *b = NULL;
 
-	lock_app_path = _lockd_process_mgr_get_pkgname();
+	lockd_metrics_inc(LOCKD_CNT_LAUNCH);
+	start_us = lockd_metrics_now();
+	STARTER_TRACE1(launch_begin, pkgname);
+	pid = aul_launch_app(pkgname, b);
+	STARTER_TRACE2(launch_end, pkgname, pid);
+	lockd_metrics_observe_since(LOCKD_HIST_LAUNCH, start_us);
+	lockd_journal_record(LOCKD_JOURNAL_LAUNCH, pid, 0);
 
-	b = bundle_create();
+	return pid;
+}
+
+int lockd_process_mgr_restart_lock(int lock_app_pid, int screen)
+{
+	char lock_app_path[PKGNAME_MAX];
+	int pid;
 
-	bundle_add(b, "mode", "normal");
+	/* a lock app on the relock channel only has to be told */
+	if (lockd_channel_relock(lock_app_pid) == 0) {
+		lockd_metrics_inc(LOCKD_CNT_RELOCK_CHANNEL);
+		LOCKD_DBG("Reset : relock sent to pid %d", lock_app_pid);
+		return lock_app_pid;
+	}
 
-	pid = aul_launch_app(lock_app_path, b);
+	lockd_process_mgr_copy_pkgname(lock_app_path, sizeof(lock_app_path));
+
+	lockd_metrics_inc(LOCKD_CNT_RESTART);
+	pid = _lockd_process_mgr_launch(lock_app_path,
+					_lockd_process_mgr_get_bundle(screen));
 
 	LOCKD_DBG("Reset : aul_launch_app(%s, NULL), pid = %d", lock_app_path,
 		  pid);
 
-	if (b)
-		bundle_free(b);
-
 	return pid;
 }
 
-int
-lockd_process_mgr_start_lock(void *data, int (*dead_cb) (int, void *))
+int lockd_process_mgr_start_lock(int screen)
 {
-	char *lock_app_path = NULL;
+	char lock_app_path[PKGNAME_MAX];
 	int pid;
 	bundle *b = NULL;
 
-	lock_app_path = _lockd_process_mgr_get_pkgname();
-
-	b = bundle_create();
-
-	bundle_add(b, "mode", "normal");
+	lockd_process_mgr_copy_pkgname(lock_app_path, sizeof(lock_app_path));
+	b = _lockd_process_mgr_get_bundle(screen);
 
 	int i;
 	for (i=0; i<RETRY_MAXCOUNT; i++)
 	{
-		pid = aul_launch_app(lock_app_path, b);
+		pid = _lockd_process_mgr_launch(lock_app_path, b);
 
 		LOCKD_DBG("aul_launch_app(%s, NULL), pid = %d", lock_app_path, pid);
 
 		if (pid == AUL_R_ECOMM) {
 			LOCKD_DBG("Relaunch lock application [%d]times", i);
+			lockd_metrics_inc(LOCKD_CNT_LAUNCH_RETRY);
 			usleep(RELAUNCH_INTERVAL);
 		} else if (pid == AUL_R_ERROR) {
 			LOCKD_DBG("launch[%s] is failed, launch default lock screen", lock_app_path);
-			pid = aul_launch_app(LOCKD_DEFAULT_LOCKSCREEN, b);
+			lockd_metrics_inc(LOCKD_CNT_LAUNCH_DEFAULT);
+			pid = _lockd_process_mgr_launch(LOCKD_DEFAULT_LOCKSCREEN, b);
 			if (pid >0) {
-				aul_listen_app_dead_signal(dead_cb, data);
-				if (b)
-					bundle_free(b);
+				lockd_boost_start(pid);
 				return pid;
 			}
 		} else {
-			/* set listen and dead signal */
-			aul_listen_app_dead_signal(dead_cb, data);
-			if (b)
-				bundle_free(b);
+			if (pid < 0)
+				lockd_metrics_inc(LOCKD_CNT_LAUNCH_FAIL);
+			else
+				lockd_boost_start(pid);
 			return pid;
 		}
 	}
 	LOCKD_DBG("Relaunch lock application failed..!!");
+	lockd_metrics_inc(LOCKD_CNT_LAUNCH_FAIL);
+	return pid;
+}
+
+int lockd_process_mgr_prepare_lock(int screen)
+{
+	char lock_app_path[PKGNAME_MAX];
+	int pid;
+
+	lockd_process_mgr_copy_pkgname(lock_app_path, sizeof(lock_app_path));
+
+	/* nobody waits for it : no retry, no fallback to the default */
+	pid = _lockd_process_mgr_launch(lock_app_path,
+					_lockd_process_mgr_get_prepare_bundle
+					(screen));
+
+	LOCKD_DBG("Prepare : aul_launch_app(%s, NULL), pid = %d",
+		  lock_app_path, pid);
+
 	return pid;
 }
 
@@ -118,14 +288,14 @@ lockd_process_mgr_terminate_lock_app(int lock_app_pid, int state)
 	     state);
 
 	if (state == 1) {
-		if (lock_app_pid != 0) {
+		if (lock_app_pid > 0) {
 			LOCKD_DBG("Terminate Lock app(pid : %d)", lock_app_pid);
 			aul_terminate_pid(lock_app_pid);
 		}
 	}
 }
 
-int lockd_process_mgr_check_lock(int pid)
+static int _lockd_process_mgr_check_lock(int pid)
 {
 	char buf[128];
 	LOCKD_DBG("%s, %d", __func__, __LINE__);
@@ -144,3 +314,14 @@ int lockd_process_mgr_check_lock(int pid)
 	}
 	return FALSE;
 }
+
+int lockd_process_mgr_check_lock(int pid)
+{
+	int r;
+
+	r = _lockd_process_mgr_check_lock(pid);
+	lockd_journal_record(LOCKD_JOURNAL_CHECK_LOCK, pid, r);
+	STARTER_TRACE2(check_lock, pid, r);
+
+	return r;
+}
@@ -0,0 +1,322 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <Ecore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/timerfd.h>
+
+#include "lockd-debug.h"
+#include "lockd-metrics.h"
+#include "lockd-suspend.h"
+#include "lockd-wakeup.h"
+
+#define SUSPEND_LOCK_NAME	"starter-lock"
+#define SUSPEND_WAKE_LOCK	"/sys/power/wake_lock"
+#define SUSPEND_WAKE_UNLOCK	"/sys/power/wake_unlock"
+/* a cold lock app launch, with room to spare */
+#define SUSPEND_TIMEOUT_MS	3000
+
+struct suspend_backend {
+	const char *name;
+	int (*open) (void);
+	/* timeout_ms bounds the block even if starter never releases it */
+	int (*acquire) (unsigned int timeout_ms);
+	void (*release) (void);
+	void (*close) (void);
+};
+
+static struct {
+	const struct suspend_backend *backend;
+	unsigned int timeout_ms;
+	int timer_fd;
+	Ecore_Fd_Handler *timer_handler;
+
+	pthread_mutex_t lock;
+	/* a bit per screen waiting for its lock window */
+	unsigned int waiting;
+	uint64_t start_us;
+
+	/* sysfs */
+	int lock_fd;
+	int unlock_fd;
+	/* local */
+	int held;
+} suspend = {
+	.timer_fd = -1,
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.lock_fd = -1,
+	.unlock_fd = -1,
+};
+
+static int _sysfs_open(void)
+{
+	suspend.lock_fd = open(SUSPEND_WAKE_LOCK, O_WRONLY | O_CLOEXEC);
+	if (suspend.lock_fd < 0)
+		return -1;
+
+	suspend.unlock_fd = open(SUSPEND_WAKE_UNLOCK, O_WRONLY | O_CLOEXEC);
+	if (suspend.unlock_fd < 0) {
+		close(suspend.lock_fd);
+		suspend.lock_fd = -1;
+		return -1;
+	}
+
+	return 0;
+}
+
+static int _sysfs_acquire(unsigned int timeout_ms)
+{
+	char buf[64];
+	int len;
+
+	/* the kernel drops a wake lock with a timeout (in ns) by itself */
+	len = snprintf(buf, sizeof(buf), "%s %llu", SUSPEND_LOCK_NAME,
+		       (unsigned long long)timeout_ms * 1000000ULL);
+	if (write(suspend.lock_fd, buf, len) != len)
+		return -1;
+
+	return 0;
+}
+
+static void _sysfs_release(void)
+{
+	if (write(suspend.unlock_fd, SUSPEND_LOCK_NAME,
+		  sizeof(SUSPEND_LOCK_NAME) - 1) < 0)
+		LOCKD_ERR("Cannot release wake lock : %s", strerror(errno));
+}
+
+static void _sysfs_close(void)
+{
+	if (suspend.lock_fd >= 0)
+		close(suspend.lock_fd);
+	if (suspend.unlock_fd >= 0)
+		close(suspend.unlock_fd);
+	suspend.lock_fd = suspend.unlock_fd = -1;
+}
+
+static int _local_open(void)
+{
+	suspend.held = 0;
+
+	return 0;
+}
+
+/* only checks that acquire and release alternate */
+static int _local_acquire(unsigned int timeout_ms)
+{
+	if (suspend.held)
+		LOCKD_ERR("local suspend blocker acquired twice");
+	suspend.held = 1;
+
+	return 0;
+}
+
+static void _local_release(void)
+{
+	if (!suspend.held)
+		LOCKD_ERR("local suspend blocker released while not held");
+	suspend.held = 0;
+}
+
+static void _local_close(void)
+{
+}
+
+static const struct suspend_backend suspend_backends[] = {
+	{ "sysfs", _sysfs_open, _sysfs_acquire, _sysfs_release, _sysfs_close },
+	{ "local", _local_open, _local_acquire, _local_release, _local_close },
+};
+
+#define SUSPEND_BACKEND_MAX \
+	(int)(sizeof(suspend_backends) / sizeof(suspend_backends[0]))
+
+/* called with suspend.lock held */
+static void _lockd_suspend_drop(void)
+{
+	struct itimerspec its;
+
+	memset(&its, 0, sizeof(its));
+	timerfd_settime(suspend.timer_fd, 0, &its, NULL);
+
+	suspend.backend->release();
+	suspend.waiting = 0;
+	lockd_metrics_observe_since(LOCKD_HIST_SUSPEND_BLOCK, suspend.start_us);
+}
+
+static Eina_Bool _lockd_suspend_timeout_cb(void *data, Ecore_Fd_Handler *fdh)
+{
+	uint64_t expired;
+
+	lockd_wakeup_source("suspend block timeout");
+
+	if (read(suspend.timer_fd, &expired, sizeof(expired)) < 0)
+		return ECORE_CALLBACK_RENEW;
+
+	pthread_mutex_lock(&suspend.lock);
+	if (suspend.waiting) {
+		LOCKD_ERR("No lock window after %u ms (screens %x), "
+			  "suspend allowed", suspend.timeout_ms,
+			  suspend.waiting);
+		lockd_metrics_inc(LOCKD_CNT_SUSPEND_TIMEOUT);
+		_lockd_suspend_drop();
+	}
+	pthread_mutex_unlock(&suspend.lock);
+
+	return ECORE_CALLBACK_RENEW;
+}
+
+static const struct suspend_backend *_lockd_suspend_backend(void)
+{
+	const char *env;
+	int i;
+
+	env = getenv("STARTER_SUSPEND_BLOCKER");
+	if (env != NULL && env[0] != '\0') {
+		for (i = 0; i < SUSPEND_BACKEND_MAX; i++) {
+			if (strcmp(env, suspend_backends[i].name) != 0)
+				continue;
+			if (suspend_backends[i].open() < 0) {
+				LOCKD_ERR("Cannot open %s suspend blocker", env);
+				return NULL;
+			}
+			return &suspend_backends[i];
+		}
+		if (strcmp(env, "none") != 0)
+			LOCKD_ERR("Unknown suspend blocker %s", env);
+		return NULL;
+	}
+
+	if (suspend_backends[0].open() < 0)
+		return NULL;
+
+	return &suspend_backends[0];
+}
+
+int lockd_suspend_init(void)
+{
+	const char *env;
+
+	if (suspend.backend != NULL)
+		return 0;
+
+	suspend.backend = _lockd_suspend_backend();
+	if (suspend.backend == NULL) {
+		LOCKD_DBG("no suspend blocker, LCD off may suspend mid launch");
+		return -1;
+	}
+
+	suspend.timer_fd = timerfd_create(CLOCK_MONOTONIC,
+					  TFD_NONBLOCK | TFD_CLOEXEC);
+	if (suspend.timer_fd < 0) {
+		LOCKD_ERR("Cannot create suspend block timer : %s",
+			  strerror(errno));
+		suspend.backend->close();
+		suspend.backend = NULL;
+		return -1;
+	}
+	suspend.timer_handler =
+	    ecore_main_fd_handler_add(suspend.timer_fd, ECORE_FD_READ,
+				      _lockd_suspend_timeout_cb, NULL, NULL,
+				      NULL);
+
+	env = getenv("STARTER_SUSPEND_TIMEOUT_MS");
+	suspend.timeout_ms = env ? atoi(env) : 0;
+	if (suspend.timeout_ms == 0)
+		suspend.timeout_ms = SUSPEND_TIMEOUT_MS;
+
+	LOCKD_DBG("%s suspend blocker, %u ms at most", suspend.backend->name,
+		  suspend.timeout_ms);
+
+	return 0;
+}
+
+void lockd_suspend_block(int screen)
+{
+	struct itimerspec its;
+
+	if (suspend.backend == NULL)
+		return;
+
+	pthread_mutex_lock(&suspend.lock);
+	if (suspend.waiting == 0) {
+		if (suspend.backend->acquire(suspend.timeout_ms) < 0) {
+			LOCKD_ERR("Cannot block suspend : %s", strerror(errno));
+			pthread_mutex_unlock(&suspend.lock);
+			return;
+		}
+		suspend.start_us = lockd_metrics_now();
+		lockd_metrics_inc(LOCKD_CNT_SUSPEND_BLOCK);
+
+		memset(&its, 0, sizeof(its));
+		its.it_value.tv_sec = suspend.timeout_ms / 1000;
+		its.it_value.tv_nsec = (suspend.timeout_ms % 1000) * 1000000;
+		timerfd_settime(suspend.timer_fd, 0, &its, NULL);
+	}
+	suspend.waiting |= 1U << screen;
+	pthread_mutex_unlock(&suspend.lock);
+}
+
+void lockd_suspend_release(int screen)
+{
+	if (suspend.backend == NULL)
+		return;
+
+	pthread_mutex_lock(&suspend.lock);
+	if (suspend.waiting & (1U << screen)) {
+		suspend.waiting &= ~(1U << screen);
+		if (suspend.waiting == 0)
+			_lockd_suspend_drop();
+	}
+	pthread_mutex_unlock(&suspend.lock);
+}
+
+int lockd_suspend_blocked(void)
+{
+	int r;
+
+	pthread_mutex_lock(&suspend.lock);
+	r = suspend.waiting != 0;
+	pthread_mutex_unlock(&suspend.lock);
+
+	return r;
+}
+
+void lockd_suspend_fini(void)
+{
+	if (suspend.backend == NULL)
+		return;
+
+	pthread_mutex_lock(&suspend.lock);
+	if (suspend.waiting)
+		_lockd_suspend_drop();
+	pthread_mutex_unlock(&suspend.lock);
+
+	if (suspend.timer_handler)
+		ecore_main_fd_handler_del(suspend.timer_handler);
+	close(suspend.timer_fd);
+	suspend.backend->close();
+
+	suspend.timer_handler = NULL;
+	suspend.timer_fd = -1;
+	suspend.backend = NULL;
+}
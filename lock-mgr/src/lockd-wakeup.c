@@ -0,0 +1,216 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <Ecore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/select.h>
+
+#include "lockd-debug.h"
+#include "lockd-wakeup.h"
+#include "lockd-watchdog.h"
+
+#define WAKEUP_SOURCE_MAX	32
+#define WAKEUP_NAME_MAX		64
+#define WAKEUP_REPORT_MAX	8
+
+struct wakeup_source {
+	char name[WAKEUP_NAME_MAX];
+	int fd;
+	unsigned int total;
+	unsigned int idle;
+};
+
+static struct {
+	int enabled;
+	Ecore_Select_Function select_func;
+
+	int idle;
+	time_t idle_start;
+	unsigned int wakeups;
+	unsigned int idle_wakeups;
+
+	int n_sources;
+	struct wakeup_source source[WAKEUP_SOURCE_MAX];
+} wakeup;
+
+static struct wakeup_source *_lockd_wakeup_get(const char *name, int fd)
+{
+	struct wakeup_source *src;
+	char path[32];
+	char link[WAKEUP_NAME_MAX / 2];
+	ssize_t len;
+	int i;
+
+	for (i = 0; i < wakeup.n_sources; i++) {
+		src = &wakeup.source[i];
+		if (fd >= 0 && src->fd == fd)
+			return src;
+		if (fd < 0 && name && strcmp(src->name, name) == 0)
+			return src;
+	}
+
+	if (wakeup.n_sources == WAKEUP_SOURCE_MAX)
+		return NULL;
+
+	src = &wakeup.source[wakeup.n_sources++];
+	src->fd = fd;
+	if (fd >= 0) {
+		snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+		len = readlink(path, link, sizeof(link) - 1);
+		if (len < 0)
+			len = 0;
+		link[len] = '\0';
+		snprintf(src->name, WAKEUP_NAME_MAX, "fd %d (%s)", fd, link);
+	} else {
+		snprintf(src->name, WAKEUP_NAME_MAX, "%s", name);
+	}
+
+	return src;
+}
+
+static void _lockd_wakeup_count(const char *name, int fd)
+{
+	struct wakeup_source *src;
+
+	src = _lockd_wakeup_get(name, fd);
+	if (src == NULL)
+		return;
+
+	src->total++;
+	if (wakeup.idle)
+		src->idle++;
+}
+
+static int
+_lockd_wakeup_select(int nfds, fd_set * readfds, fd_set * writefds,
+		     fd_set * exceptfds, struct timeval *timeout)
+{
+	int ret;
+	int fd;
+
+	ret = wakeup.select_func(nfds, readfds, writefds, exceptfds, timeout);
+
+	wakeup.wakeups++;
+	if (wakeup.idle)
+		wakeup.idle_wakeups++;
+
+	if (ret == 0) {
+		_lockd_wakeup_count("timer", -1);
+	} else if (ret > 0) {
+		for (fd = 0; fd < nfds; fd++) {
+			if ((readfds && FD_ISSET(fd, readfds))
+			    || (writefds && FD_ISSET(fd, writefds))
+			    || (exceptfds && FD_ISSET(fd, exceptfds)))
+				_lockd_wakeup_count(NULL, fd);
+		}
+	}
+
+	return ret;
+}
+
+void lockd_wakeup_init(void)
+{
+	const char *env;
+
+	if (wakeup.enabled)
+		return;
+
+	env = getenv("STARTER_WAKEUP_AUDIT");
+	if (env == NULL || atoi(env) == 0)
+		return;
+
+	wakeup.select_func = ecore_main_loop_select_func_get();
+	if (wakeup.select_func == NULL)
+		wakeup.select_func = select;
+	ecore_main_loop_select_func_set(_lockd_wakeup_select);
+
+	wakeup.enabled = TRUE;
+	LOCKD_DBG("wakeup audit enabled");
+}
+
+void lockd_wakeup_source(const char *name)
+{
+	lockd_watchdog_handler(name);
+
+	if (!wakeup.enabled || name == NULL)
+		return;
+
+	_lockd_wakeup_count(name, -1);
+}
+
+void lockd_wakeup_idle_begin(void)
+{
+	int i;
+
+	if (!wakeup.enabled || wakeup.idle)
+		return;
+
+	for (i = 0; i < wakeup.n_sources; i++)
+		wakeup.source[i].idle = 0;
+	wakeup.idle_wakeups = 0;
+	wakeup.idle_start = time(NULL);
+	wakeup.idle = TRUE;
+}
+
+unsigned int lockd_wakeup_idle_count(void)
+{
+	return wakeup.idle_wakeups;
+}
+
+void lockd_wakeup_idle_end(void)
+{
+	struct wakeup_source *top[WAKEUP_REPORT_MAX];
+	struct wakeup_source *src;
+	unsigned int secs;
+	int n = 0;
+	int i, j;
+
+	if (!wakeup.enabled || !wakeup.idle)
+		return;
+
+	wakeup.idle = FALSE;
+
+	secs = time(NULL) - wakeup.idle_start;
+	if (secs == 0)
+		secs = 1;
+
+	LOCKD_DBG("wakeup audit: screen off %u sec, %u wakeups, %u.%02u/min",
+		  secs, wakeup.idle_wakeups, wakeup.idle_wakeups * 60 / secs,
+		  (wakeup.idle_wakeups * 6000 / secs) % 100);
+
+	/* keep the busiest sources, insertion sorted */
+	for (i = 0; i < wakeup.n_sources; i++) {
+		src = &wakeup.source[i];
+		if (src->idle == 0)
+			continue;
+		for (j = n; j > 0 && top[j - 1]->idle < src->idle; j--) {
+			if (j < WAKEUP_REPORT_MAX)
+				top[j] = top[j - 1];
+		}
+		if (j < WAKEUP_REPORT_MAX)
+			top[j] = src;
+		if (n < WAKEUP_REPORT_MAX)
+			n++;
+	}
+
+	for (i = 0; i < n; i++)
+		LOCKD_DBG("wakeup audit:   %-40s %u (total %u)", top[i]->name,
+			  top[i]->idle, top[i]->total);
+}
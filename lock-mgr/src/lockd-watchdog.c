@@ -0,0 +1,260 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <Ecore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <execinfo.h>
+#include <inttypes.h>
+#include <sys/select.h>
+
+#include "lockd-debug.h"
+#include "lockd-metrics.h"
+#include "lockd-watchdog.h"
+
+#define WATCHDOG_SIGNAL		SIGUSR2
+#define WATCHDOG_FRAMES_MAX	32
+#define WATCHDOG_NAME_MAX	64
+/* how long to wait for the main thread to take its stack */
+#define WATCHDOG_STACK_WAIT_MS	100
+
+static struct {
+	int enabled;
+	Ecore_Select_Function select_func;
+	pthread_t main_thread;
+	pthread_t tid;
+	uint64_t threshold_us;
+
+	/* the running iteration, written by the main loop only */
+	volatile uint64_t busy_since;	/* 0 while in select() */
+	volatile unsigned int iteration;
+	volatile int ready_fd;		/* -1 : timer */
+	const char *volatile handler;
+
+	/* written by the watchdog thread */
+	volatile unsigned int reported;
+	volatile int stalled;
+
+	/* the main thread's stack, taken in the signal handler */
+	void *frames[WATCHDOG_FRAMES_MAX];
+	volatile int n_frames;
+} watchdog;
+
+static void _lockd_watchdog_sig(int signo)
+{
+	int saved_errno = errno;
+
+	watchdog.n_frames = backtrace(watchdog.frames, WATCHDOG_FRAMES_MAX);
+	errno = saved_errno;
+}
+
+static int
+_lockd_watchdog_select(int nfds, fd_set * readfds, fd_set * writefds,
+		       fd_set * exceptfds, struct timeval *timeout)
+{
+	uint64_t now;
+	int ret;
+	int fd;
+
+	if (watchdog.busy_since) {
+		now = lockd_metrics_now();
+		lockd_metrics_observe(LOCKD_HIST_LOOP_ITER,
+				      now - watchdog.busy_since);
+		if (watchdog.stalled) {
+			LOCKD_ERR("main loop stall ended after %" PRIu64 " ms",
+				  (now - watchdog.busy_since) / 1000);
+			watchdog.stalled = FALSE;
+		}
+	}
+	watchdog.busy_since = 0;
+
+	ret = watchdog.select_func(nfds, readfds, writefds, exceptfds,
+				   timeout);
+
+	watchdog.ready_fd = -1;
+	for (fd = 0; ret > 0 && fd < nfds; fd++) {
+		if ((readfds && FD_ISSET(fd, readfds))
+		    || (writefds && FD_ISSET(fd, writefds))) {
+			watchdog.ready_fd = fd;
+			break;
+		}
+	}
+	watchdog.handler = NULL;
+	watchdog.iteration++;
+
+	/* the thread must see the new iteration before its start */
+	__sync_synchronize();
+	watchdog.busy_since = lockd_metrics_now();
+
+	return ret;
+}
+
+static void _lockd_watchdog_source(char *buf, int len, int fd)
+{
+	char path[32];
+	char link[WATCHDOG_NAME_MAX];
+	ssize_t n;
+
+	if (fd < 0) {
+		snprintf(buf, len, "timer");
+		return;
+	}
+
+	snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+	n = readlink(path, link, sizeof(link) - 1);
+	if (n < 0)
+		n = 0;
+	link[n] = '\0';
+	snprintf(buf, len, "fd %d (%s)", fd, link);
+}
+
+static void _lockd_watchdog_report(unsigned int iteration, uint64_t busy_us)
+{
+	char handler[WATCHDOG_NAME_MAX];
+	char source[WATCHDOG_NAME_MAX * 2];
+	const char *name;
+	char **symbols;
+	int waited;
+	int n;
+	int i;
+
+	/* taken before the stack, the main loop may move on meanwhile */
+	name = watchdog.handler;
+	snprintf(handler, sizeof(handler), "%s", name ? name : "unknown");
+	_lockd_watchdog_source(source, sizeof(source), watchdog.ready_fd);
+
+	watchdog.n_frames = -1;
+	__sync_synchronize();
+	pthread_kill(watchdog.main_thread, WATCHDOG_SIGNAL);
+	for (waited = 0; watchdog.n_frames < 0
+	     && waited < WATCHDOG_STACK_WAIT_MS; waited++)
+		usleep(1000);
+	n = watchdog.n_frames;
+
+	lockd_metrics_inc(LOCKD_CNT_LOOP_STALL);
+	LOCKD_ERR("main loop stall : iteration %u busy for %" PRIu64
+		  " ms, handler %s, woken up by %s", iteration, busy_us / 1000,
+		  handler, source);
+
+	if (watchdog.iteration != iteration) {
+		LOCKD_ERR("  the iteration ended before its stack was taken");
+		return;
+	}
+	if (n <= 0) {
+		LOCKD_ERR("  no stack from the main thread");
+		return;
+	}
+
+	symbols = backtrace_symbols(watchdog.frames, n);
+	/* frame 0 and 1 are the signal handler and the signal trampoline */
+	for (i = 2; i < n; i++)
+		LOCKD_ERR("  #%d %s", i - 2,
+			  symbols ? symbols[i] : "?");
+	free(symbols);
+}
+
+static void *_lockd_watchdog_thread(void *data)
+{
+	struct timespec period;
+	uint64_t since;
+	unsigned int iteration;
+
+	/* a few looks per threshold, a stall is seen at most 25% late */
+	period.tv_sec = watchdog.threshold_us / 4 / 1000000;
+	period.tv_nsec = (watchdog.threshold_us / 4 % 1000000) * 1000;
+
+	for (;;) {
+		nanosleep(&period, NULL);
+
+		iteration = watchdog.iteration;
+		__sync_synchronize();
+		since = watchdog.busy_since;
+		if (since == 0 || iteration == watchdog.reported)
+			continue;
+		if (lockd_metrics_now() - since < watchdog.threshold_us)
+			continue;
+
+		watchdog.reported = iteration;
+		watchdog.stalled = TRUE;
+		_lockd_watchdog_report(iteration, lockd_metrics_now() - since);
+	}
+
+	return NULL;
+}
+
+void lockd_watchdog_init(void)
+{
+	struct sigaction sa;
+	void *frame;
+	const char *env;
+	int ms;
+	int r;
+
+	if (watchdog.enabled)
+		return;
+
+	env = getenv("STARTER_WATCHDOG_MS");
+	if (env == NULL || (ms = atoi(env)) <= 0)
+		return;
+
+	/* backtrace() loads libgcc on its first call, not in a handler */
+	backtrace(&frame, 1);
+
+	/*
+	 * SA_RESTART keeps most syscalls going, but a usleep() the main loop
+	 * is stalled in returns early once per reported stall.
+	 */
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = _lockd_watchdog_sig;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+	if (sigaction(WATCHDOG_SIGNAL, &sa, NULL) < 0) {
+		LOCKD_ERR("Cannot set the watchdog signal handler");
+		return;
+	}
+
+	watchdog.threshold_us = (uint64_t)ms * 1000;
+	watchdog.main_thread = pthread_self();
+	watchdog.ready_fd = -1;
+	watchdog.reported = (unsigned int)-1;
+
+	watchdog.select_func = ecore_main_loop_select_func_get();
+	if (watchdog.select_func == NULL)
+		watchdog.select_func = select;
+	ecore_main_loop_select_func_set(_lockd_watchdog_select);
+
+	r = pthread_create(&watchdog.tid, NULL, _lockd_watchdog_thread, NULL);
+	if (r != 0) {
+		LOCKD_ERR("Cannot start the watchdog thread (%d)", r);
+		ecore_main_loop_select_func_set(watchdog.select_func);
+		return;
+	}
+	pthread_detach(watchdog.tid);
+
+	watchdog.enabled = TRUE;
+	LOCKD_DBG("main loop watchdog enabled, %d ms", ms);
+}
+
+void lockd_watchdog_handler(const char *name)
+{
+	watchdog.handler = name;
+}
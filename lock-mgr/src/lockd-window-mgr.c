@@ -23,33 +23,50 @@
 #include <app.h>
 
 #include "lockd-debug.h"
+#include "lockd-metrics.h"
 #include "lockd-window-mgr.h"
+#include "lockd-trace.h"
 
 #define PACKAGE 		"starter"
 
+/* let the lock app draw its first frames before the snapshot is taken */
+#define SNAPSHOT_DELAY		0.5
+
 struct _lockw_data {
+	/* the X screen this context locks */
+	Ecore_X_Window root;
+	int root_w;
+	int root_h;
+	/* this client's event selection on root before any sniff, -1 unknown */
+	long root_mask;
+
 	Ecore_X_Window input_x_window;
 
-	Evas_Object *main_win;
-	Evas_Object *main_layout;
+	/*
+	 * Shown from LCD off until the lock app's window is up. Its background
+	 * is a server side copy of the last lock screen, so mapping it costs
+	 * no client rendering.
+	 */
+	Ecore_X_Window placeholder;
+	Ecore_X_Pixmap snapshot;
+	Ecore_Timer *snapshot_timer;
+	Eina_Bool placeholder_shown;
 
 	Ecore_X_Window lock_x_window;
 
-	Ecore_Event_Handler *h_keydown;
 	Ecore_Event_Handler *h_wincreate;
 	Ecore_Event_Handler *h_winshow;
 
-};
-
-static Eina_Bool _lockd_window_key_down_cb(void *data, int type, void *event)
-{
-	LOCKD_DBG("Key Down CB.");
+	/* on the lock window until it is first painted */
+	Ecore_X_Damage damage;
+	Ecore_Event_Handler *h_damage;
 
-	return ECORE_CALLBACK_PASS_ON;
-}
+	Eina_Bool sniffing;
+};
 
 static int
-_lockd_window_check_validate_rect(Ecore_X_Display * dpy, Ecore_X_Window window)
+_lockd_window_check_validate_rect(lockw_data * lockw, Ecore_X_Display * dpy,
+				  Ecore_X_Window window)
 {
 	Ecore_X_Window root;
 	Ecore_X_Window child;
@@ -66,14 +83,16 @@ _lockd_window_check_validate_rect(Ecore_X_Display * dpy, Ecore_X_Window window)
 
 	Eina_Bool ret = FALSE;
 
-	root = ecore_x_window_root_first_get();
+	root = lockw->root;
 
 	if (XGetGeometry
 	    (dpy, window, &root, &rel_x, &rel_y, &width, &height, &border,
 	     &depth)) {
 		if (XTranslateCoordinates
 		    (dpy, window, root, 0, 0, &abs_x, &abs_y, &child)) {
-			if ((abs_x - border) >= 480 || (abs_y - border) >= 800
+			/* fails above if the window is on another screen */
+			if ((abs_x - border) >= lockw->root_w
+			    || (abs_y - border) >= lockw->root_h
 			    || (width + abs_x) <= 0 || (height + abs_y) <= 0) {
 				ret = FALSE;
 			} else {
@@ -118,7 +137,55 @@ static Window get_user_created_window(Window win)
 
 }
 
-void
+int lockd_window_event_window(void *event)
+{
+	Ecore_X_Event_Window_Create *e = event;
+
+	return get_user_created_window((Window) (e->win));
+}
+
+int lockd_window_event_pid(void *event)
+{
+	int pid = 0;
+
+	ecore_x_netwm_pid_get(lockd_window_event_window(event), &pid);
+
+	return pid;
+}
+
+int lockd_window_event_drawable(void *event)
+{
+	Ecore_X_Event_Damage *e = event;
+
+	return e->drawable;
+}
+
+void lockd_window_mgr_set_lock_window(lockw_data * lockw, Ecore_X_Window win)
+{
+	if (lockw == NULL || win == 0)
+		return;
+
+	lockw->lock_x_window = win;
+
+	ecore_x_icccm_name_class_set(win, "LOCK_SCREEN", "LOCK_SCREEN");
+
+	ecore_x_netwm_window_type_set(win, ECORE_X_WINDOW_TYPE_NOTIFICATION);
+
+	utilx_set_system_notification_level(ecore_x_display_get(), win,
+					    UTILX_NOTIFICATION_LEVEL_NORMAL);
+
+	utilx_set_window_opaque_state(ecore_x_display_get(), win,
+				      UTILX_OPAQUE_STATE_ON);
+
+	STARTER_TRACE1(window_props, win);
+}
+
+Ecore_X_Window lockd_window_mgr_get_lock_window(lockw_data * lockw)
+{
+	return lockw ? lockw->lock_x_window : 0;
+}
+
+int
 lockd_window_set_window_property(lockw_data * data, int lock_app_pid,
 				 void *event)
 {
@@ -126,12 +193,15 @@ lockd_window_set_window_property(lockw_data * data, int lock_app_pid,
 	Ecore_X_Window user_window = 0;
 	lockw_data *lockw = (lockw_data *) data;
 	int pid = 0;
+	uint64_t start_us;
 
 	if (!lockw) {
-		return;
+		return FALSE;
 	}
 	LOCKD_DBG("%s, %d", __func__, __LINE__);
 
+	start_us = lockd_metrics_now();
+
 	user_window = get_user_created_window((Window) (e->win));
 
 	ecore_x_netwm_pid_get(user_window, &pid);
@@ -141,27 +211,95 @@ lockd_window_set_window_property(lockw_data * data, int lock_app_pid,
 
 	if (lock_app_pid == pid) {
 		if (_lockd_window_check_validate_rect
-		    (ecore_x_display_get(), user_window) == TRUE) {
-			lockw->lock_x_window = user_window;
+		    (lockw, ecore_x_display_get(), user_window) == TRUE) {
 			LOCKD_DBG
 			    ("This is lock application. Set window property. win id : %x",
 			     user_window);
 
-			ecore_x_icccm_name_class_set(user_window, "LOCK_SCREEN",
-						     "LOCK_SCREEN");
+			lockd_window_mgr_set_lock_window(lockw, user_window);
 
-			ecore_x_netwm_window_type_set(user_window,
-						      ECORE_X_WINDOW_TYPE_NOTIFICATION);
+			lockd_metrics_inc(LOCKD_CNT_WIN_MATCH);
+			lockd_metrics_observe_since(LOCKD_HIST_WIN_MATCH,
+						    start_us);
+			return TRUE;
+		}
+	}
 
-			utilx_set_system_notification_level(ecore_x_display_get
-							    (), user_window,
-							    UTILX_NOTIFICATION_LEVEL_NORMAL);
+	lockd_metrics_observe_since(LOCKD_HIST_WIN_MATCH, start_us);
+	return FALSE;
+}
 
-			utilx_set_window_opaque_state(ecore_x_display_get(),
-						      user_window,
-						      UTILX_OPAQUE_STATE_ON);
-		}
+static void _lockd_window_take(lockw_data * lockw, Ecore_X_Window win,
+			       int *shown)
+{
+	utilx_set_window_effect_state(ecore_x_display_get(), win, 0);
+	lockd_window_mgr_set_lock_window(lockw, win);
+	lockd_metrics_inc(LOCKD_CNT_WIN_MATCH);
+	if (shown)
+		*shown = ecore_x_window_visible_get(win);
+}
+
+/*
+ * Looks for the lock app's window among the screen's top level windows.
+ * Used when the launch ran off the main loop : the create and show events
+ * may have been handled before lock_app_pid was known.
+ */
+int lockd_window_mgr_find_lock_window(lockw_data * lockw, int lock_app_pid,
+				      int *shown)
+{
+	Ecore_X_Window *children;
+	Ecore_X_Window user_window;
+	int found = FALSE;
+	int n = 0;
+	int pid;
+	int i;
+
+	if (lockw == NULL || lock_app_pid <= 0)
+		return FALSE;
+
+	children = ecore_x_window_children_get(lockw->root, &n);
+	if (children == NULL)
+		return FALSE;
+
+	/* top of the stack first */
+	for (i = n - 1; i >= 0; i--) {
+		user_window = get_user_created_window((Window) children[i]);
+		pid = 0;
+		ecore_x_netwm_pid_get(user_window, &pid);
+		if (pid != lock_app_pid
+		    || _lockd_window_check_validate_rect(lockw,
+							 ecore_x_display_get(),
+							 user_window) == FALSE)
+			continue;
+
+		LOCKD_DBG("lock app window %x was already there", user_window);
+		_lockd_window_take(lockw, user_window, shown);
+		found = TRUE;
+		break;
 	}
+	free(children);
+
+	return found;
+}
+
+int lockd_window_mgr_bind_lock_window(lockw_data * lockw, Ecore_X_Window win,
+				      int lock_app_pid, int *shown)
+{
+	int pid = 0;
+
+	if (lockw == NULL || win == 0 || lock_app_pid <= 0)
+		return FALSE;
+
+	/* destroyed, or the XID reused by another client */
+	if (!ecore_x_netwm_pid_get(win, &pid) || pid != lock_app_pid
+	    || _lockd_window_check_validate_rect(lockw, ecore_x_display_get(),
+						 win) == FALSE)
+		return FALSE;
+
+	LOCKD_DBG("lock app window %x is still there", win);
+	_lockd_window_take(lockw, win, shown);
+
+	return TRUE;
 }
 
 void
@@ -169,8 +307,13 @@ lockd_window_set_window_effect(lockw_data * data, int lock_app_pid, void *event)
 {
 	Ecore_X_Event_Window_Create *e = event;
 	Ecore_X_Window user_window = 0;
+	lockw_data *lockw = (lockw_data *) data;
 	int pid = 0;
 
+	if (!lockw) {
+		return;
+	}
+
 	user_window = get_user_created_window((Window) (e->win));
 	ecore_x_netwm_pid_get(user_window, &pid);
 
@@ -181,7 +324,7 @@ lockd_window_set_window_effect(lockw_data * data, int lock_app_pid, void *event)
 
 	if (lock_app_pid == pid) {
 		if (_lockd_window_check_validate_rect
-		    (ecore_x_display_get(), user_window) == TRUE) {
+		    (lockw, ecore_x_display_get(), user_window) == TRUE) {
 			LOCKD_DBG
 			    ("This is lock application. Disable window effect. win id : %x\n",
 			     user_window);
@@ -192,36 +335,212 @@ lockd_window_set_window_effect(lockw_data * data, int lock_app_pid, void *event)
 	}
 }
 
+static Eina_Bool _lockd_window_snapshot_cb(void *data)
+{
+	lockw_data *lockw = (lockw_data *) data;
+	Ecore_X_Display *dpy = ecore_x_display_get();
+	Ecore_X_Pixmap pmap;
+	GC gc;
+	int w = 0, h = 0;
+	int depth;
+
+	lockw->snapshot_timer = NULL;
+
+	if (lockw->lock_x_window == 0)
+		return ECORE_CALLBACK_CANCEL;
+
+	/* an ARGB lock window cannot be copied into a root depth pixmap */
+	depth = ecore_x_window_depth_get(lockw->root);
+	if (ecore_x_window_depth_get(lockw->lock_x_window) != depth) {
+		LOCKD_DBG("lock window depth differs, no snapshot");
+		return ECORE_CALLBACK_CANCEL;
+	}
+
+	ecore_x_window_geometry_get(lockw->lock_x_window, NULL, NULL, &w, &h);
+	if (w <= 0 || h <= 0)
+		return ECORE_CALLBACK_CANCEL;
+	if (w > lockw->root_w)
+		w = lockw->root_w;
+	if (h > lockw->root_h)
+		h = lockw->root_h;
+
+	pmap = ecore_x_pixmap_new(lockw->root, lockw->root_w, lockw->root_h,
+				  depth);
+	if (pmap == 0) {
+		LOCKD_ERR("Cannot create snapshot pixmap");
+		return ECORE_CALLBACK_CANCEL;
+	}
+
+	gc = XCreateGC(dpy, pmap, 0, NULL);
+	XFillRectangle(dpy, pmap, gc, 0, 0, lockw->root_w, lockw->root_h);
+	XCopyArea(dpy, lockw->lock_x_window, pmap, gc, 0, 0, w, h, 0, 0);
+	XFreeGC(dpy, gc);
+
+	ecore_x_window_pixmap_set(lockw->placeholder, pmap);
+	if (lockw->snapshot)
+		ecore_x_pixmap_free(lockw->snapshot);
+	lockw->snapshot = pmap;
+
+	LOCKD_DBG("lock screen snapshot taken (%dx%d)", w, h);
+
+	return ECORE_CALLBACK_CANCEL;
+}
+
+void lockd_window_mgr_show_placeholder(lockw_data * lockw)
+{
+	if (lockw == NULL || lockw->placeholder == 0
+	    || lockw->placeholder_shown)
+		return;
+
+	ecore_x_window_show(lockw->placeholder);
+	ecore_x_window_raise(lockw->placeholder);
+	ecore_x_flush();
+	lockw->placeholder_shown = EINA_TRUE;
+
+	LOCKD_DBG("placeholder shown (%s)",
+		  lockw->snapshot ? "snapshot" : "blank");
+}
+
+void lockd_window_mgr_hide_placeholder(lockw_data * lockw)
+{
+	if (lockw == NULL || !lockw->placeholder_shown)
+		return;
+
+	ecore_x_window_hide(lockw->placeholder);
+	lockw->placeholder_shown = EINA_FALSE;
+}
+
+/* the lock window is up : drop the placeholder and refresh the snapshot */
+void lockd_window_mgr_lock_shown(lockw_data * lockw)
+{
+	if (lockw == NULL)
+		return;
+
+	lockd_window_mgr_hide_placeholder(lockw);
+	lockd_window_mgr_stop_sniff(lockw);
+
+	if (lockw->snapshot_timer)
+		ecore_timer_del(lockw->snapshot_timer);
+	lockw->snapshot_timer =
+	    ecore_timer_add(SNAPSHOT_DELAY, _lockd_window_snapshot_cb, lockw);
+}
+
+static void _lockd_window_unwatch_damage(lockw_data * lockw)
+{
+	if (lockw->h_damage != NULL) {
+		ecore_event_handler_del(lockw->h_damage);
+		lockw->h_damage = NULL;
+	}
+	if (lockw->damage != 0) {
+		ecore_x_damage_free(lockw->damage);
+		lockw->damage = 0;
+	}
+}
+
+/*
+ * Setting the properties says nothing about what is on the panel, the lock
+ * app may still be loading its theme. With ReportNonEmpty the server sends
+ * a single notify once the window has been drawn to, and another only after
+ * the damage is subtracted.
+ */
+int
+lockd_window_mgr_watch_damage(void *data, lockw_data * lockw,
+			      Eina_Bool(*damage_cb) (void *, int, void *))
+{
+	if (lockw == NULL || lockw->lock_x_window == 0)
+		return FALSE;
+
+	_lockd_window_unwatch_damage(lockw);
+
+	if (!ecore_x_damage_query())
+		return FALSE;
+
+	lockw->damage = ecore_x_damage_new(lockw->lock_x_window,
+					   ECORE_X_DAMAGE_REPORT_NON_EMPTY);
+	if (lockw->damage == 0) {
+		LOCKD_ERR("Cannot watch lock window %x for damage",
+			  lockw->lock_x_window);
+		return FALSE;
+	}
+	lockw->h_damage =
+	    ecore_event_handler_add(ECORE_X_EVENT_DAMAGE_NOTIFY, damage_cb,
+				    data);
+
+	return TRUE;
+}
+
+int lockd_window_mgr_lock_painted(lockw_data * lockw, void *event)
+{
+	Ecore_X_Event_Damage *e = event;
+
+	if (lockw == NULL || lockw->damage == 0 || e->damage != lockw->damage)
+		return FALSE;
+
+	/* drawn before the map, nobody has seen that */
+	if (!ecore_x_window_visible_get(lockw->lock_x_window)) {
+		ecore_x_damage_subtract(lockw->damage, 0, 0);
+		return FALSE;
+	}
+
+	_lockd_window_unwatch_damage(lockw);
+
+	return TRUE;
+}
+
+/*
+ * Window create/show events of other clients are only needed while we are
+ * waiting for the lock app's window, so root is sniffed only in between.
+ */
+static void _lockd_window_sniff_start(lockw_data * lockw)
+{
+	if (lockw->sniffing)
+		return;
+
+	ecore_x_window_client_sniff(lockw->root);
+	lockw->sniffing = EINA_TRUE;
+}
+
+void lockd_window_mgr_stop_sniff(lockw_data * lockw)
+{
+	if (lockw == NULL || !lockw->sniffing)
+		return;
+
+	/* the sniff replaced the selection, others on root may rely on it */
+	if (lockw->root_mask >= 0)
+		XSelectInput(ecore_x_display_get(), lockw->root,
+			     lockw->root_mask);
+	else
+		ecore_x_event_mask_unset(lockw->root,
+					 ECORE_X_EVENT_MASK_WINDOW_CHILD_CONFIGURE
+					 | ECORE_X_EVENT_MASK_WINDOW_PROPERTY);
+	lockw->sniffing = EINA_FALSE;
+}
+
 void
 lockd_window_mgr_ready_lock(void *data, lockw_data * lockw,
 			    Eina_Bool(*create_cb) (void *, int, void *),
 			    Eina_Bool(*show_cb) (void *, int, void *))
 {
-	Ecore_X_Window xwin;
-
 	if (lockw == NULL) {
 		LOCKD_ERR("lockw is NULL.");
 		return;
 	}
 
-	lockw->h_wincreate =
-	    ecore_event_handler_add(ECORE_X_EVENT_WINDOW_CREATE, create_cb,
-				    data);
-	lockw->h_winshow =
-	    ecore_event_handler_add(ECORE_X_EVENT_WINDOW_SHOW, show_cb, data);
-
-	xwin = lockw->input_x_window;
-	utilx_grab_key(ecore_x_display_get(), xwin, KEY_SELECT, EXCLUSIVE_GRAB);
-
-	lockw->h_keydown =
-	    ecore_event_handler_add(ECORE_EVENT_KEY_DOWN,
-				    _lockd_window_key_down_cb, NULL);
+	_lockd_window_sniff_start(lockw);
+
+	/* a lock over one that is still waiting for its window, or the same */
+	if (lockw->h_wincreate == NULL)
+		lockw->h_wincreate =
+		    ecore_event_handler_add(ECORE_X_EVENT_WINDOW_CREATE,
+					    create_cb, data);
+	if (lockw->h_winshow == NULL)
+		lockw->h_winshow =
+		    ecore_event_handler_add(ECORE_X_EVENT_WINDOW_SHOW, show_cb,
+					    data);
 }
 
 void lockd_window_mgr_finish_lock(lockw_data * lockw)
 {
-	Ecore_X_Window xwin;
-
 	if (lockw == NULL) {
 		LOCKD_ERR("lockw is NULL.");
 		return;
@@ -235,36 +554,82 @@ void lockd_window_mgr_finish_lock(lockw_data * lockw)
 		lockw->h_winshow = NULL;
 	}
 
-	xwin = lockw->input_x_window;
-	utilx_ungrab_key(ecore_x_display_get(), xwin, KEY_SELECT);
+	lockd_window_mgr_stop_sniff(lockw);
+	lockd_window_mgr_hide_placeholder(lockw);
+	_lockd_window_unwatch_damage(lockw);
 
-	if (lockw->h_keydown != NULL) {
-		ecore_event_handler_del(lockw->h_keydown);
-		lockw->h_keydown = NULL;
+	if (lockw->snapshot_timer != NULL) {
+		ecore_timer_del(lockw->snapshot_timer);
+		lockw->snapshot_timer = NULL;
 	}
+	lockw->lock_x_window = 0;
+}
+
+Ecore_X_Window lockd_window_mgr_get_input_window(lockw_data * lockw)
+{
+	if (lockw == NULL)
+		return 0;
+
+	return lockw->input_x_window;
 }
 
-lockw_data *lockd_window_init(void)
+void lockd_window_fini(lockw_data * lockw)
+{
+	if (lockw == NULL)
+		return;
+
+	_lockd_window_unwatch_damage(lockw);
+	if (lockw->snapshot_timer)
+		ecore_timer_del(lockw->snapshot_timer);
+	if (lockw->placeholder)
+		ecore_x_window_free(lockw->placeholder);
+	if (lockw->snapshot)
+		ecore_x_pixmap_free(lockw->snapshot);
+	if (lockw->input_x_window)
+		ecore_x_window_free(lockw->input_x_window);
+
+	free(lockw);
+}
+
+lockw_data *lockd_window_init(Ecore_X_Window root)
 {
 	lockw_data *lockw = NULL;
 	Ecore_X_Window input_x_window;
-	Ecore_X_Window root_window;
+	XWindowAttributes att;
 	long pid;
 
 	lockw = (lockw_data *) malloc(sizeof(lockw_data));
+	if (lockw == NULL) {
+		LOCKD_ERR("Cannot allocate lockw_data");
+		return NULL;
+	}
 	memset(lockw, 0x0, sizeof(lockw_data));
 
 	pid = getpid();
 
-	input_x_window = ecore_x_window_input_new(0, 0, 0, 1, 1);
+	lockw->root = root;
+	ecore_x_window_size_get(root, &lockw->root_w, &lockw->root_h);
+
+	/* once : a round trip on every LCD off would be in the way */
+	lockw->root_mask = -1;
+	if (XGetWindowAttributes(ecore_x_display_get(), root, &att))
+		lockw->root_mask = att.your_event_mask;
+	LOCKD_DBG("screen root %x, %dx%d", root, lockw->root_w, lockw->root_h);
+
+	input_x_window = ecore_x_window_input_new(root, 0, 0, 1, 1);
 	ecore_x_icccm_title_set(input_x_window, "lock-daemon-input-window");
 	ecore_x_netwm_name_set(input_x_window, "lock-daemon-input-window");
 	ecore_x_netwm_pid_set(input_x_window, pid);
 	LOCKD_DBG("Created input window : %p", input_x_window);
 	lockw->input_x_window = input_x_window;
 
-	root_window = ecore_x_window_root_first_get();
-	ecore_x_window_client_sniff(root_window);
+	/* black until the first lock screen has been seen */
+	lockw->placeholder =
+	    ecore_x_window_override_new(root, 0, 0, lockw->root_w,
+					lockw->root_h);
+	ecore_x_window_background_color_set(lockw->placeholder, 0, 0, 0);
+	ecore_x_icccm_title_set(lockw->placeholder, "lock-daemon-placeholder");
+	ecore_x_netwm_pid_set(lockw->placeholder, pid);
 
 	return lockw;
 }
@@ -23,11 +23,21 @@ BuildRequires:  pkgconfig(capi-appfw-application)
 %description
 Description: Starter
 
+%package devel
+Summary:    starter lock screen interfaces
+Group:      Development/Libraries
+Requires:   %{name} = %{version}-%{release}
+
+%description devel
+Headers of the lock state page, the lock plugin, the relock channel and
+the lock control socket, for lock screen apps and plugins.
+
 
 %prep
 %setup -q
 
-cmake . -DCMAKE_INSTALL_PREFIX=%{_prefix}
+cmake . -DCMAKE_INSTALL_PREFIX=%{_prefix} \
+	%{?startup_optimized:-DSTARTER_STARTUP_OPTIMIZED=ON}
 
 %build
 
@@ -48,6 +58,8 @@ change_file_executable()
 
 vconftool set -t int "memory/starter/sequence" 0 -i -u 5000 -g 5000
 vconftool set -t string file/private/lockscreen/pkgname "org.tizen.draglock" -u 5000 -g 5000
+vconftool set -t int file/private/lockscreen/speculative 0 -u 5000 -g 5000
+vconftool set -t string file/private/lockscreen/emergency_pkgname "" -u 0 -g 0
 vconftool -i set -t int memory/idle_lock/state "0" -u 5000 -g 5000
 
 ln -sf /etc/init.d/rd4starter /etc/rc.d/rc4.d/S81starter
@@ -64,4 +76,13 @@ sync
 %{_sysconfdir}/init.d/rd4starter
 %{_sysconfdir}/init.d/rd3starter
 %{_bindir}/starter
+%{_bindir}/starter-metrics
+%{_bindir}/starterctl
 %{_libdir}/liblock-daemon.so
+
+%files devel
+%defattr(-,root,root,-)
+%{_includedir}/starter/starter-lockstate.h
+%{_includedir}/starter/starter-lock-plugin.h
+%{_includedir}/starter/starter-lock-channel.h
+%{_includedir}/starter/starter-lock-control.h
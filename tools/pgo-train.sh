@@ -0,0 +1,53 @@
+#!/bin/sh
+#
+# pgo-train.sh : profile guided, startup optimized build of starter and
+# liblock-daemon.
+#
+#   tools/pgo-train.sh <build dir> [journal ...]
+#
+# Configures <build dir> with STARTER_STARTUP_OPTIMIZED and
+# STARTER_PGO=generate, builds, trains liblock-daemon with the lock daemon
+# checks run by ctest (the stand-ins of tools/replay answer for vconf, aul, X
+# and the main loop), then rebuilds the same tree with STARTER_PGO=use.
+# Journals recorded on a device (STARTER_JOURNAL) are replayed as well, by
+# starter-replay.
+#
+# starter itself needs X and the platform daemons : to train it, install the
+# generate build on a device, boot and lock it a few times, and copy the
+# profiles back into <build dir>/pgo before the use step.
+#
+
+set -e
+
+if [ $# -lt 1 ]; then
+	echo "usage: $0 <build dir> [journal ...]" >&2
+	exit 2
+fi
+
+SRC=$(cd "$(dirname "$0")/.." && pwd)
+BUILD=$1
+shift
+mkdir -p "$BUILD"
+BUILD=$(cd "$BUILD" && pwd)
+PGO="$BUILD/pgo"
+REPLAY="$BUILD/tools/starter-replay"
+
+configure()
+{
+	(cd "$BUILD" && cmake "$SRC" -DSTARTER_STARTUP_OPTIMIZED=ON \
+		-DSTARTER_PGO=$1 -DSTARTER_PGO_DIR="$PGO")
+	make -C "$BUILD"
+}
+
+configure generate
+rm -rf "$PGO"
+
+# LCD off to lock round trips, restarts with the lock app up, relock over
+# the channel, speculative launch on dim, the fast path under load, ...
+(cd "$BUILD" && ctest > /dev/null)
+for j in "$@"; do
+	"$REPLAY" -f "$j" > /dev/null
+done
+
+configure use
+echo "profiles in $PGO, optimized build in $BUILD"
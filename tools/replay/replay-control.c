@@ -0,0 +1,172 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * replay-control : lock, check the state and unlock over the lock control
+ * socket, subscribed to the changes. Reports request -> locked latencies and
+ * fails if a change was not seen by the subscriber. Uses the fast path like
+ * replay-stress does, STARTER_LOCK_FASTPATH=0 for the main loop route.
+ *
+ *   replay-control [-v] [cycles]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <vconf-keys.h>
+
+#include "lock-daemon.h"
+#include "lockd-metrics.h"
+#include "lockd-fastpath.h"
+#include "lockd-suspend.h"
+#include "replay.h"
+
+#define CONTROL_CYCLES		100
+
+static int _control_run(int cycles)
+{
+	const struct lockd_metrics_page *m = lockd_metrics_get();
+	struct starter_lock_control_msg msg;
+	char dir[] = "/tmp/starter-control.XXXXXX";
+	char path[PATH_MAX];
+	uint64_t *lat;
+	uint64_t start_ns, locks, p50, p99;
+	int fast;
+	int ctl, sub;
+	int missed = 0;
+	int n = 0;
+	int pid;
+	int i;
+
+	lat = calloc(cycles, sizeof(uint64_t));
+	if (lat == NULL || mkdtemp(dir) == NULL) {
+		fprintf(stderr, "cannot set up the control run\n");
+		free(lat);
+		return 2;
+	}
+	/* the fast path watches a file of ours, PM state stays normal */
+	snprintf(path, sizeof(path), "%s/state", dir);
+	setenv("STARTER_PM_STATE_FILE", path, 1);
+	replay_set_pm_state(path, VCONFKEY_PM_STATE_NORMAL);
+
+	start_lock_daemon();
+	fast = lockd_fastpath_enabled();
+	locks = m->counter[LOCKD_CNT_LOCK].value;
+
+	ctl = replay_control_connect();
+	sub = replay_control_connect();
+	if (ctl < 0 || sub < 0
+	    || replay_control_request(sub, STARTER_LOCK_CONTROL_SUBSCRIBE,
+				      &msg) != 0) {
+		fprintf(stderr, "control: cannot reach the control socket\n");
+		stop_lock_daemon();
+		free(lat);
+		return 1;
+	}
+
+	for (i = 0; i < cycles; i++) {
+		start_ns = replay_now();
+		if (replay_control_request(ctl, STARTER_LOCK_CONTROL_LOCK,
+					   &msg) != 0
+		    || replay_control_wait(sub, STARTER_LOCK_CONTROL_EVENT,
+					   &msg) < 0
+		    || msg.state != VCONFKEY_IDLE_LOCK) {
+			missed++;
+			break;
+		}
+		lat[n++] = (replay_now() - start_ns) / 1000;
+
+		/* locked like an LCD off, suspend waits for the window */
+		if (!lockd_suspend_blocked()) {
+			fprintf(stderr, "control: suspend not blocked\n");
+			missed++;
+			break;
+		}
+		pid = replay.live_pid;
+		replay_input(LOCKD_JOURNAL_WIN_CREATE, REPLAY_FAKE_WINDOW + 1,
+			     pid);
+		replay_input(LOCKD_JOURNAL_WIN_SHOW, REPLAY_FAKE_WINDOW + 1,
+			     pid);
+		if (lockd_suspend_blocked()) {
+			fprintf(stderr, "control: suspend still blocked\n");
+			missed++;
+			break;
+		}
+
+		if (replay_control_request(ctl, STARTER_LOCK_CONTROL_STATUS,
+					   &msg) != 0
+		    || msg.state != VCONFKEY_IDLE_LOCK || msg.pid != pid) {
+			fprintf(stderr, "control: status says %d, pid %d\n",
+				msg.state, msg.pid);
+			missed++;
+			break;
+		}
+
+		/* terminated by the unlock, then gone */
+		if (replay_control_request(ctl, STARTER_LOCK_CONTROL_UNLOCK,
+					   &msg) != 0) {
+			missed++;
+			break;
+		}
+		replay_input(LOCKD_JOURNAL_APP_DEAD, pid, 0);
+		if (replay_control_wait(sub, STARTER_LOCK_CONTROL_EVENT,
+					&msg) < 0
+		    || msg.state != VCONFKEY_IDLE_UNLOCK) {
+			missed++;
+			break;
+		}
+	}
+	locks = m->counter[LOCKD_CNT_LOCK].value - locks;
+
+	close(ctl);
+	close(sub);
+	stop_lock_daemon();
+	replay_drain();
+	unlink(path);
+	rmdir(dir);
+
+	p50 = replay_percentile(lat, n, 50);
+	p99 = replay_percentile(lat, n, 99);
+
+	printf("fast path    %s\n", fast ? "on" : "off");
+	printf("cycles       %d lock/status/unlock over the control socket\n",
+	       cycles);
+	printf("locks        %" PRIu64 "\n", locks);
+	printf("lock request -> locked event p50 %" PRIu64 " us, p99 %"
+	       PRIu64 " us\n", p50, p99);
+	free(lat);
+
+	if (missed || locks != (uint64_t)cycles) {
+		fprintf(stderr, "control: %d of %d cycles locked and unlocked "
+			"as asked\n", n - missed, cycles);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int cycles;
+
+	cycles = replay_test_init(argc, argv, CONTROL_CYCLES, 1);
+	if (cycles < 0)
+		return 2;
+
+	return replay_test_fini(_control_run(cycles));
+}
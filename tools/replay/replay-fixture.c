@@ -0,0 +1,425 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The replay harness's driver, see replay.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/select.h>
+#include <sys/stat.h>
+
+#include "lock-daemon.h"
+#include "lockd-journal.h"
+#include "lockd-metrics.h"
+#include "lockd-keys.h"
+#include "replay.h"
+
+struct replay_state replay = {
+	.async_lock = PTHREAD_MUTEX_INITIALIZER,
+	.next_fake_pid = REPLAY_FAKE_PID_BASE,
+	.control_fd = -1,
+};
+
+/* ---------------------------------------------------------------------- */
+/* setup                                                                    */
+
+/* whatever runs here stays away from the system's lock daemon */
+void replay_setup(int fastpath)
+{
+	/* never record the replay itself */
+	unsetenv("STARTER_JOURNAL");
+	unsetenv("STARTER_WAKEUP_AUDIT");
+	/* nor take over a lock state left by the system's daemon */
+	setenv("STARTER_LOCK_PERSIST", "", 1);
+	/* nor block the system's suspend */
+	setenv("STARTER_SUSPEND_BLOCKER", "local", 0);
+	/* inputs are handled as they come unless the fast path is tested */
+	if (!fastpath)
+		setenv("STARTER_LOCK_FASTPATH", "0", 1);
+
+	lock_daemon_set_noti_subscriber(replay_noti_subscribe,
+					replay_noti_unsubscribe);
+}
+
+/* a check's command line, [-v] [cycles] : the cycles, or -1 */
+int replay_test_init(int argc, char *argv[], int cycles, int fastpath)
+{
+	int opt;
+
+	while ((opt = getopt(argc, argv, "v")) != -1) {
+		switch (opt) {
+		case 'v':
+			replay.verbose = 1;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-v] [cycles]\n", argv[0]);
+			return -1;
+		}
+	}
+	if (optind < argc)
+		cycles = atoi(argv[optind]);
+	if (cycles <= 0) {
+		fprintf(stderr, "%s needs at least one cycle\n", argv[0]);
+		return -1;
+	}
+
+	replay.fast = 1;
+	replay_setup(fastpath);
+
+	return cycles;
+}
+
+/* what every check has to pass on top of its own */
+int replay_test_fini(int ret)
+{
+	if (ret == 0 && replay.handler_leaks) {
+		fprintf(stderr, "%d event handler(s) leaked\n",
+			replay.handler_leaks);
+		return 1;
+	}
+
+	return ret;
+}
+
+/* ---------------------------------------------------------------------- */
+/* journal                                                                  */
+
+uint64_t replay_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void replay_wait(uint64_t start_ns, uint64_t ts_ns)
+{
+	struct timespec ts;
+	uint64_t now;
+
+	now = replay_now() - start_ns;
+	if (now >= ts_ns)
+		return;
+
+	ts.tv_sec = (ts_ns - now) / 1000000000;
+	ts.tv_nsec = (ts_ns - now) % 1000000000;
+	nanosleep(&ts, NULL);
+}
+
+/* next recorded result of the given type, or NULL once they run out */
+struct lockd_journal_record *replay_pop(struct replay_queue *q)
+{
+	while (q->pos < replay.n_rec) {
+		if (replay.rec[q->pos++].type == q->type)
+			return &replay.rec[q->pos - 1];
+	}
+
+	return NULL;
+}
+
+static void _replay_window(struct lockd_journal_record *r,
+			   replay_event_cb cb, void *data, int type)
+{
+	unsigned int event[16];
+
+	/* the window exists whether or not the daemon listens */
+	replay.win = r->arg[0];
+	replay.win_pid = r->arg[1];
+	replay.win_mapped = (type == ECORE_X_EVENT_WINDOW_SHOW);
+
+	if (cb == NULL)
+		return;
+
+	/* create and show events both start with the window id */
+	memset(event, 0, sizeof(event));
+	event[0] = r->arg[0];
+
+	cb(data, type, event);
+}
+
+static void _replay_damage(unsigned int win)
+{
+	const struct lockd_metrics_hist *h =
+	    &lockd_metrics_get()->hist[LOCKD_HIST_LOCK_VISIBLE];
+	unsigned int event[16];
+	uint64_t visible;
+
+	if (replay.damage_cb == NULL)
+		return;
+
+	/* level, drawable and damage lead Ecore_X_Event_Damage */
+	memset(event, 0, sizeof(event));
+	event[1] = win;
+	event[2] = (win == replay.damage_win) ? REPLAY_FAKE_DAMAGE : 0;
+
+	visible = h->count;
+	replay.damage_cb(replay.damage_data, ECORE_X_EVENT_DAMAGE_NOTIFY,
+			 event);
+	if (h->count != visible && !replay.win_mapped)
+		replay.early_visible++;
+}
+
+/* ---------------------------------------------------------------------- */
+/* lock control                                                             */
+
+/* non blocking, replay_control_wait() runs the main loop meanwhile */
+int replay_control_connect(void)
+{
+	int fd;
+
+	fd = starter_lock_control_connect();
+	if (fd < 0)
+		return -1;
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+	return fd;
+}
+
+/* runs the main loop until fd gets a message of this type, or gives up */
+int replay_control_wait(int fd, int type,
+			struct starter_lock_control_msg *msg)
+{
+	struct timespec ts = { 0, 20000 };
+	uint64_t end = replay_now() + (uint64_t)REPLAY_WAIT_US * 1000;
+	int r;
+
+	for (;;) {
+		replay_fd_dispatch(0);
+		replay_drain();
+		while ((r = starter_lock_control_recv(fd, msg)) > 0) {
+			if (msg->type == type)
+				return 0;
+		}
+		if (r < 0 || replay_now() > end)
+			return -1;
+		nanosleep(&ts, NULL);
+	}
+}
+
+int replay_control_request(int fd, int type,
+			   struct starter_lock_control_msg *reply)
+{
+	if (starter_lock_control_send(fd, type) < 0
+	    || replay_control_wait(fd, type, reply) < 0)
+		return -1;
+
+	return reply->error;
+}
+
+/* a request from the journal, sent the way its client did */
+static void _replay_control(int type)
+{
+	struct starter_lock_control_msg reply;
+
+	if (replay.control_fd < 0)
+		replay.control_fd = replay_control_connect();
+	if (replay.control_fd < 0
+	    || replay_control_request(replay.control_fd, type, &reply) != 0)
+		fprintf(stderr, "lock control request '%c' failed\n", type);
+}
+
+/* ---------------------------------------------------------------------- */
+/* driver                                                                   */
+
+void replay_dispatch(struct lockd_journal_record *r)
+{
+	struct replay_keynode node;
+
+	switch (r->type) {
+	case LOCKD_JOURNAL_PM_STATE:
+		node.val = r->arg[0];
+		if (replay.pm_cb)
+			replay.pm_cb(&node, replay.pm_data);
+		break;
+	case LOCKD_JOURNAL_LOCK_STATE:
+		node.val = r->arg[0];
+		if (replay.lock_cb)
+			replay.lock_cb(&node, replay.lock_data);
+		break;
+	case LOCKD_JOURNAL_APP_DEAD:
+		if (r->arg[0] == replay.live_pid)
+			replay.live_pid = 0;
+		if (replay.dead_cb)
+			replay.dead_cb(r->arg[0], replay.dead_data);
+		break;
+	case LOCKD_JOURNAL_WIN_CREATE:
+		_replay_window(r, replay.create_cb, replay.create_data,
+			       ECORE_X_EVENT_WINDOW_CREATE);
+		break;
+	case LOCKD_JOURNAL_WIN_SHOW:
+		_replay_window(r, replay.show_cb, replay.show_data,
+			       ECORE_X_EVENT_WINDOW_SHOW);
+		break;
+	case LOCKD_JOURNAL_NOTI:
+		if (r->arg[0] == LOCKD_JOURNAL_NOTI_POWER_OFF
+		    && replay.power_off_cb)
+			replay.power_off_cb(replay.power_off_data);
+		break;
+	case LOCKD_JOURNAL_CONTROL:
+		_replay_control(r->arg[0]);
+		break;
+	case LOCKD_JOURNAL_KEY:
+		lockd_keys_action(r->arg[1], r->arg[0]);
+		break;
+	case LOCKD_JOURNAL_WIN_DAMAGE:
+		_replay_damage(r->arg[0]);
+		break;
+	default:
+		/* results and outputs are consumed by the stand-ins */
+		return;
+	}
+
+	replay.inputs++;
+}
+
+/* an input the way the journal records it */
+void replay_input(uint32_t type, int a0, int a1)
+{
+	struct lockd_journal_record r;
+
+	memset(&r, 0, sizeof(r));
+	r.type = type;
+	r.arg[0] = a0;
+	r.arg[1] = a1;
+	replay_dispatch(&r);
+}
+
+/*
+ * one main loop iteration over the registered fd handlers, through the
+ * select function the daemon installed as ecore's would : what select
+ * returned, 0 when the timeout expired
+ */
+int replay_fd_dispatch(int timeout_ms)
+{
+	struct replay_fd_handler *h[REPLAY_FD_HANDLER_MAX];
+	replay_select_cb func = replay.select_func;
+	struct timeval tv;
+	fd_set rfds;
+	int nfds = 0;
+	int n = 0;
+	int ret;
+	int i;
+
+	FD_ZERO(&rfds);
+	for (i = 0; i < REPLAY_FD_HANDLER_MAX; i++) {
+		if (!replay.fdh[i].used)
+			continue;
+		h[n++] = &replay.fdh[i];
+		FD_SET(replay.fdh[i].fd, &rfds);
+		if (replay.fdh[i].fd >= nfds)
+			nfds = replay.fdh[i].fd + 1;
+	}
+
+	tv.tv_sec = timeout_ms / 1000;
+	tv.tv_usec = (timeout_ms % 1000) * 1000;
+	if (func == NULL)
+		func = select;
+	ret = func(nfds, &rfds, NULL, NULL, &tv);
+	if (ret <= 0)
+		return ret;
+
+	for (i = 0; i < n; i++) {
+		/* an earlier handler may have removed this one */
+		if (!h[i]->used || !FD_ISSET(h[i]->fd, &rfds))
+			continue;
+		FD_CLR(h[i]->fd, &rfds);
+		if (h[i]->cb(h[i]->data, h[i]) == 0)
+			h[i]->used = 0;
+	}
+
+	return ret;
+}
+
+/* runs what the daemon's threads posted, as the main loop would */
+void replay_drain(void)
+{
+	struct replay_async async[REPLAY_ASYNC_MAX];
+	int n;
+	int i;
+
+	pthread_mutex_lock(&replay.async_lock);
+	n = replay.n_async;
+	memcpy(async, replay.async, n * sizeof(struct replay_async));
+	replay.n_async = 0;
+	pthread_mutex_unlock(&replay.async_lock);
+
+	for (i = 0; i < n; i++)
+		async[i].cb(async[i].data);
+}
+
+/* the vconf memory backend rewrites the key's file */
+void replay_set_pm_state(const char *path, int val)
+{
+	char buf[16];
+	int len;
+	int fd;
+
+	replay.pm_state = val;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+	if (fd < 0)
+		return;
+	len = snprintf(buf, sizeof(buf), "%d", val);
+	if (write(fd, buf, len) != len)
+		fprintf(stderr, "cannot write %s\n", path);
+	close(fd);
+}
+
+/* a fresh lock state file for the daemon, path is a mkstemp() template */
+int replay_persist_file(char *path)
+{
+	int fd;
+
+	fd = mkstemp(path);
+	if (fd < 0) {
+		fprintf(stderr, "cannot create %s\n", path);
+		return -1;
+	}
+	close(fd);
+	setenv("STARTER_LOCK_PERSIST", path, 1);
+
+	return 0;
+}
+
+static int _replay_cmp(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+/* sorts v, then its pct percentile, 0 if it is empty */
+uint64_t replay_percentile(uint64_t *v, int n, int pct)
+{
+	int i;
+
+	if (n <= 0)
+		return 0;
+
+	qsort(v, n, sizeof(uint64_t), _replay_cmp);
+	i = (n * pct) / 100;
+
+	return v[i < n ? i : n - 1];
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * replay-keys : lock, press home KEYS_PRESSES times and a key starter has no
+ * use for, then unlock. Reports the key handler's CPU time per press and
+ * fails if a key was grabbed while unlocked, grabbed more than once per
+ * lock, or did not run its action.
+ *
+ *   replay-keys [-v] [cycles]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <inttypes.h>
+#include <vconf-keys.h>
+
+#include "lock-daemon.h"
+#include "lockd-metrics.h"
+#include "replay.h"
+
+#define KEYS_CYCLES		50
+/* home presses per lock, the third one is the emergency */
+#define KEYS_PRESSES		5
+
+/* a key press on the lock input window, the handler's CPU time in ns */
+static uint64_t _keys_press(const char *name, unsigned int ms)
+{
+	struct replay_key_event ev;
+	struct timespec a, b;
+
+	if (replay.key_cb == NULL)
+		return 0;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.keyname = name;
+	ev.key = name;
+	ev.window = REPLAY_FAKE_WINDOW;
+	ev.event_window = REPLAY_FAKE_WINDOW;
+	ev.timestamp = ms;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &a);
+	replay.key_cb(replay.key_data, ECORE_EVENT_KEY_DOWN, &ev);
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &b);
+
+	return (b.tv_sec - a.tv_sec) * 1000000000ULL + b.tv_nsec - a.tv_nsec;
+}
+
+static int _keys_run(int cycles)
+{
+	const struct lockd_metrics_page *m = lockd_metrics_get();
+	uint64_t restarts, keys, cpu_ns = 0;
+	unsigned int ms = 0;
+	int unlocked_grab = 0;
+	int missed = 0;
+	int pid;
+	int i, j;
+
+	start_lock_daemon();
+	restarts = m->counter[LOCKD_CNT_RESTART].value;
+	keys = m->counter[LOCKD_CNT_KEY].value;
+
+	for (i = 0; i < cycles; i++) {
+		replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_LCDOFF, 0);
+		pid = replay.live_pid;
+		replay_input(LOCKD_JOURNAL_WIN_CREATE, REPLAY_FAKE_WINDOW + 1, pid);
+		replay_input(LOCKD_JOURNAL_WIN_SHOW, REPLAY_FAKE_WINDOW + 1, pid);
+		if (!replay.grabbed || replay.key_cb == NULL)
+			missed++;
+
+		/* presses in a row, then a pause that starts the count over */
+		for (j = 0; j < KEYS_PRESSES; j++) {
+			cpu_ns += _keys_press(REPLAY_KEY_HOME, ms);
+			ms += 200;
+		}
+		cpu_ns += _keys_press(REPLAY_KEY_VOLUME, ms);
+		ms += 5000;
+
+		replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_NORMAL, 0);
+		replay_input(LOCKD_JOURNAL_LOCK_STATE, VCONFKEY_IDLE_UNLOCK, 0);
+		replay_input(LOCKD_JOURNAL_APP_DEAD, pid, 0);
+		if (replay.grabbed || replay.key_cb != NULL)
+			unlocked_grab++;
+	}
+	restarts = m->counter[LOCKD_CNT_RESTART].value - restarts;
+	keys = m->counter[LOCKD_CNT_KEY].value - keys;
+	stop_lock_daemon();
+
+	printf("cycles       %d, %d home presses and one other key each\n",
+	       cycles, KEYS_PRESSES);
+	printf("keys seen    %" PRIu64 "\n", keys);
+	printf("grab calls   %d (%.1f per lock)\n", replay.grabs,
+	       (double)replay.grabs / cycles);
+	printf("wake         %" PRIu64 ", emergency %d\n", restarts,
+	       replay.emergency);
+	printf("key handler  %" PRIu64 " ns CPU per press\n",
+	       keys ? cpu_ns / keys : 0);
+
+	/* the wake of the 1st and 4th press, the emergency of the 3rd */
+	if (missed || unlocked_grab || replay.grabs != 2 * cycles
+	    || restarts != 2 * (uint64_t)cycles
+	    || replay.emergency != cycles) {
+		fprintf(stderr, "keys: %d lock(s) without the grab, %d unlock(s) "
+			"with it\n", missed, unlocked_grab);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int cycles;
+
+	cycles = replay_test_init(argc, argv, KEYS_CYCLES, 0);
+	if (cycles < 0)
+		return 2;
+
+	return replay_test_fini(_keys_run(cycles));
+}
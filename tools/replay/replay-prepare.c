@@ -0,0 +1,144 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * replay-prepare : LCD dim before each LCD off with the speculative launch
+ * on, and every other pair of dims going back to normal. Fails if an LCD off
+ * after a dim had to start the lock app, or if the wasted dims did not end
+ * with the hidden app terminated.
+ *
+ *   replay-prepare [-v] [cycles]
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <vconf-keys.h>
+
+#include "lock-daemon.h"
+#include "lockd-metrics.h"
+#include "replay.h"
+
+#define PREPARE_CYCLES		40
+/* dims in a row that may go back to normal */
+#define PREPARE_CAP		2
+
+/* LCD dim, then either LCD off and a lock round trip or back to normal */
+static void _prepare_cycle(int lock)
+{
+	const struct lockd_metrics_page *m = lockd_metrics_get();
+	uint64_t cancels;
+	int pid;
+
+	replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_LCDDIM, 0);
+
+	if (!lock) {
+		cancels = m->counter[LOCKD_CNT_SPEC_CANCEL].value;
+		replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_NORMAL,
+			     0);
+		/* the terminated hidden app goes away */
+		if (m->counter[LOCKD_CNT_SPEC_CANCEL].value != cancels)
+			replay_input(LOCKD_JOURNAL_APP_DEAD, replay.live_pid, 0);
+		return;
+	}
+
+	replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_LCDOFF, 0);
+
+	pid = replay.live_pid;
+	replay_input(LOCKD_JOURNAL_WIN_CREATE, REPLAY_FAKE_WINDOW + 1, pid);
+	replay_input(LOCKD_JOURNAL_WIN_SHOW, REPLAY_FAKE_WINDOW + 1, pid);
+
+	replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_NORMAL, 0);
+	replay_input(LOCKD_JOURNAL_LOCK_STATE, VCONFKEY_IDLE_UNLOCK, 0);
+	replay_input(LOCKD_JOURNAL_APP_DEAD, pid, 0);
+}
+
+static int _prepare_run(int cycles)
+{
+	const struct lockd_metrics_page *m = lockd_metrics_get();
+	uint64_t locks, spec, hits, cancels, starts;
+	int lcd_off = 0;
+	int wasted = 0;
+	int misses = 0;
+	int streak = 0;
+	int i;
+
+	start_lock_daemon();
+
+	/* two locks, then two dims that go back to normal */
+	for (i = 0; i < cycles; i++) {
+		if (i % 4 < 2) {
+			/* after PREPARE_CAP wasted dims nothing was prepared */
+			if (streak >= PREPARE_CAP)
+				misses++;
+			streak = 0;
+			lcd_off++;
+			_prepare_cycle(1);
+		} else {
+			streak++;
+			wasted++;
+			_prepare_cycle(0);
+		}
+	}
+	stop_lock_daemon();
+
+	locks = m->counter[LOCKD_CNT_LOCK].value;
+	spec = m->counter[LOCKD_CNT_SPEC_LAUNCH].value;
+	hits = m->counter[LOCKD_CNT_SPEC_HIT].value;
+	cancels = m->counter[LOCKD_CNT_SPEC_CANCEL].value;
+	/* launches that were neither a prepare nor a show */
+	starts = m->counter[LOCKD_CNT_LAUNCH].value - spec
+	    - m->counter[LOCKD_CNT_RESTART].value;
+
+	printf("cycles       %d (%d lcd off, %d back to normal, cap %d)\n",
+	       cycles, lcd_off, wasted, PREPARE_CAP);
+	printf("locks        %" PRIu64 "\n", locks);
+	printf("prepared     %" PRIu64 ", shown %" PRIu64 ", terminated %"
+	       PRIu64 "\n", spec, hits, cancels);
+	printf("lcd off      %" PRIu64 " lock app start(s), %d expected\n",
+	       starts, misses);
+
+	if (locks != (uint64_t)lcd_off || hits + misses != (uint64_t)lcd_off) {
+		fprintf(stderr, "prepare: %" PRIu64 " locks, %" PRIu64
+			" shown of %d lcd off\n", locks, hits, lcd_off);
+		return 1;
+	}
+	if (starts != (uint64_t)misses) {
+		fprintf(stderr, "prepare: lcd off started the lock app %"
+			PRIu64 " time(s)\n", starts);
+		return 1;
+	}
+	/* one per pair of dims that went back to normal */
+	if (cancels != (uint64_t)cycles / 4) {
+		fprintf(stderr, "prepare: %" PRIu64 " hidden app(s) "
+			"terminated\n", cancels);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int cycles;
+
+	cycles = replay_test_init(argc, argv, PREPARE_CYCLES, 0);
+	if (cycles < 0)
+		return 2;
+
+	replay.speculative = PREPARE_CAP;
+
+	return replay_test_fini(_prepare_run(cycles));
+}
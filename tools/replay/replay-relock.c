@@ -0,0 +1,125 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * replay-relock : lock once, join the relock channel as the lock app, then
+ * turn the LCD off again the given number of times. Fails if any of them
+ * went through aul instead of the channel.
+ *
+ *   replay-relock [-v] [count]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <vconf-keys.h>
+
+#include "lock-daemon.h"
+#include "lockd-metrics.h"
+#include "starter-lock-channel.h"
+#include "replay.h"
+
+#define RELOCK_COUNT		500
+#define RELOCK_WAIT_MS		1000
+
+static int _relock_run(int count)
+{
+	const struct lockd_metrics_page *m = lockd_metrics_get();
+	struct pollfd pfd;
+	uint64_t *lat;
+	uint64_t start_ns, launches, relocks;
+	int missed = 0;
+	int n = 0;
+	int fd;
+	int i;
+
+	lat = calloc(count, sizeof(uint64_t));
+	if (lat == NULL)
+		return 2;
+
+	/* the lock app is this process, SO_PEERCRED tells the daemon so */
+	replay.next_fake_pid = getpid();
+
+	start_lock_daemon();
+	replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_LCDOFF, 0);
+
+	fd = starter_lock_channel_connect();
+	if (fd < 0) {
+		fprintf(stderr, "relock: cannot join the channel\n");
+		stop_lock_daemon();
+		free(lat);
+		return 1;
+	}
+	/* accept, then the hello */
+	replay_fd_dispatch(100);
+	replay_fd_dispatch(100);
+
+	launches = m->counter[LOCKD_CNT_LAUNCH].value;
+	relocks = m->counter[LOCKD_CNT_RELOCK_CHANNEL].value;
+
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	for (i = 0; i < count; i++) {
+		replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_NORMAL,
+			     0);
+
+		start_ns = replay_now();
+		replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_LCDOFF,
+			     0);
+		if (poll(&pfd, 1, RELOCK_WAIT_MS) != 1
+		    || starter_lock_channel_read(fd) !=
+		    STARTER_LOCK_CHANNEL_RELOCK) {
+			missed++;
+			continue;
+		}
+		lat[n++] = (replay_now() - start_ns) / 1000;
+	}
+
+	launches = m->counter[LOCKD_CNT_LAUNCH].value - launches;
+	relocks = m->counter[LOCKD_CNT_RELOCK_CHANNEL].value - relocks;
+
+	stop_lock_daemon();
+	close(fd);
+
+	printf("lcd off      %d (lock app on the relock channel)\n", count);
+	printf("relocks      %" PRIu64 " over the channel, %" PRIu64
+	       " through aul\n", relocks, launches);
+	printf("lcd off -> relock received p50 %" PRIu64 " us, p99 %" PRIu64
+	       " us\n", replay_percentile(lat, n, 50),
+	       replay_percentile(lat, n, 99));
+	free(lat);
+
+	if (missed || launches) {
+		fprintf(stderr, "relock: %d relock(s) missed, %" PRIu64
+			" aul launch(es)\n", missed, launches);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int cycles;
+
+	cycles = replay_test_init(argc, argv, RELOCK_COUNT, 0);
+	if (cycles < 0)
+		return 2;
+
+	return replay_test_fini(_relock_run(cycles));
+}
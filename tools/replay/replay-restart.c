@@ -0,0 +1,150 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * replay-restart : lock, then restart the daemon with the lock app still up,
+ * every other time with the newest persisted record torn. Fails if a restart
+ * launched the lock app instead of taking it back, or did not take its window
+ * back by the persisted id while the screen's window list is not looked at.
+ *
+ *   replay-restart [-v] [cycles]
+ */
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+#include <vconf-keys.h>
+
+#include "lock-daemon.h"
+#include "lockd-metrics.h"
+#include "replay.h"
+
+#define RESTART_CYCLES		20
+
+/* a crash in the middle of a write : break the record with the larger seq */
+static void _restart_tear(const char *path)
+{
+	struct stat st;
+	uint64_t seq[2];
+	off_t half;
+	char c;
+	int fd;
+
+	fd = open(path, O_RDWR);
+	if (fd < 0)
+		return;
+	if (fstat(fd, &st) < 0 || st.st_size < 32) {
+		close(fd);
+		return;
+	}
+	half = st.st_size / 2;
+
+	/* seq follows the magic and the version */
+	if (pread(fd, &seq[0], sizeof(uint64_t), 8) == sizeof(uint64_t)
+	    && pread(fd, &seq[1], sizeof(uint64_t), half + 8)
+	    == sizeof(uint64_t)) {
+		off_t at = (seq[1] > seq[0] ? half : 0) + half / 2;
+
+		if (pread(fd, &c, 1, at) == 1) {
+			c ^= 0x5a;
+			if (pwrite(fd, &c, 1, at) != 1)
+				fprintf(stderr, "cannot tear %s\n", path);
+		}
+	}
+	close(fd);
+}
+
+static int _restart_run(int cycles)
+{
+	const struct lockd_metrics_page *m = lockd_metrics_get();
+	char persist[] = "/tmp/starter-persist.XXXXXX";
+	uint64_t launches, matches;
+	int relaunched = 0;
+	int bound = 0;
+	int pid;
+	int i;
+
+	if (replay_persist_file(persist) < 0)
+		return 2;
+
+	start_lock_daemon();
+	for (i = 0; i < cycles; i++) {
+		/* a live process, its start time is checked on restart */
+		replay.next_fake_pid = getpid();
+
+		replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_LCDOFF, 0);
+		pid = replay.live_pid;
+		replay_input(LOCKD_JOURNAL_WIN_CREATE, REPLAY_FAKE_WINDOW + 1, pid);
+		replay_input(LOCKD_JOURNAL_WIN_SHOW, REPLAY_FAKE_WINDOW + 1, pid);
+
+		launches = m->counter[LOCKD_CNT_LAUNCH].value;
+		stop_lock_daemon();
+		if (i & 1)
+			_restart_tear(persist);
+		/* a torn record falls back to one from before the window */
+		replay.no_scan = !(i & 1);
+		matches = m->counter[LOCKD_CNT_WIN_MATCH].value;
+		start_lock_daemon();
+		replay.no_scan = 0;
+		if (m->counter[LOCKD_CNT_LAUNCH].value != launches)
+			relaunched++;
+		if (!(i & 1) && m->counter[LOCKD_CNT_WIN_MATCH].value != matches)
+			bound++;
+
+		/* the new daemon has to know the app to unlock it */
+		replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_NORMAL, 0);
+		replay_input(LOCKD_JOURNAL_LOCK_STATE, VCONFKEY_IDLE_UNLOCK, 0);
+		replay_input(LOCKD_JOURNAL_APP_DEAD, pid, 0);
+	}
+	stop_lock_daemon();
+	unlink(persist);
+
+	printf("restarts     %d with the lock app up (%d torn records)\n",
+	       cycles, cycles / 2);
+	printf("taken back   %" PRIu64 "\n",
+	       m->counter[LOCKD_CNT_LOCK_ADOPT].value);
+	printf("relaunched   %d\n", relaunched);
+	printf("window       %d of %d taken back by id\n", bound,
+	       cycles - cycles / 2);
+	printf("unlocks      %" PRIu64 "\n",
+	       m->counter[LOCKD_CNT_UNLOCK].value);
+
+	if (relaunched
+	    || m->counter[LOCKD_CNT_LOCK_ADOPT].value != (uint64_t)cycles
+	    || m->counter[LOCKD_CNT_UNLOCK].value != (uint64_t)cycles) {
+		fprintf(stderr, "restart: lock app not taken back\n");
+		return 1;
+	}
+	if (bound != cycles - cycles / 2) {
+		fprintf(stderr, "restart: persisted lock window not used\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int cycles;
+
+	cycles = replay_test_init(argc, argv, RESTART_CYCLES, 0);
+	if (cycles < 0)
+		return 2;
+
+	return replay_test_fini(_restart_run(cycles));
+}
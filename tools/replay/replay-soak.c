@@ -0,0 +1,240 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * replay-soak : synthetic lock/unlock cycles, with a daemon restart every
+ * SOAK_RESTART_EVERY cycles. Fails if the heap or the fd table keeps growing
+ * once the warm up is over, if handling LCD off allocates at all, or if a
+ * lock was not seen visible at the paint after its window was mapped.
+ *
+ *   replay-soak [-v] [cycles]
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <dirent.h>
+#include <vconf-keys.h>
+
+#include "lock-daemon.h"
+#include "lockd-metrics.h"
+#include "replay.h"
+
+#define SOAK_CYCLES		1000
+#define SOAK_RESTART_EVERY	50
+/* heap bytes a steady state may still drift by (allocator bookkeeping) */
+#define SOAK_HEAP_SLACK		256
+
+struct soak_sample {
+	long heap;
+	long rss_kb;
+	int fds;
+};
+
+/*
+ * What the allocator handed out and got back, not mallinfo() : that counts
+ * chunks glibc keeps in its per thread caches as in use, and those fill up
+ * at a pace that depends on how the daemon was compiled.
+ */
+static long _soak_heap(void)
+{
+	return __atomic_load_n(&replay.heap, __ATOMIC_RELAXED);
+}
+
+static long _soak_rss_kb(void)
+{
+	char buf[64];
+	long size = 0, rss = 0;
+	ssize_t len;
+	int fd;
+
+	fd = open("/proc/self/statm", O_RDONLY);
+	if (fd < 0)
+		return -1;
+	len = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+	if (len <= 0)
+		return -1;
+	buf[len] = '\0';
+
+	if (sscanf(buf, "%ld %ld", &size, &rss) != 2)
+		return -1;
+
+	return rss * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static int _soak_fds(void)
+{
+	struct dirent *de;
+	DIR *dir;
+	int n = 0;
+
+	dir = opendir("/proc/self/fd");
+	if (dir == NULL)
+		return -1;
+	while ((de = readdir(dir)) != NULL) {
+		if (de->d_name[0] != '.')
+			n++;
+	}
+	closedir(dir);
+
+	/* the directory stream's own fd */
+	return n - 1;
+}
+
+static void _soak_sample(struct soak_sample *s)
+{
+	/* heap first, the fd walk allocates and frees a DIR */
+	s->heap = _soak_heap();
+	s->rss_kb = _soak_rss_kb();
+	s->fds = _soak_fds();
+}
+
+/* one LCD off -> lock window -> unlock -> lock app exit round trip */
+static void _soak_cycle(void)
+{
+	int pid;
+
+	replay.count_allocs = 1;
+	replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_LCDOFF, 0);
+	replay.count_allocs = 0;
+
+	pid = replay.live_pid;
+	replay_input(LOCKD_JOURNAL_WIN_CREATE, REPLAY_FAKE_WINDOW + 1, pid);
+	/* painted while unmapped does not count, after the map it does */
+	replay_input(LOCKD_JOURNAL_WIN_DAMAGE, REPLAY_FAKE_WINDOW + 1, 0);
+	replay_input(LOCKD_JOURNAL_WIN_SHOW, REPLAY_FAKE_WINDOW + 1, pid);
+	replay_input(LOCKD_JOURNAL_WIN_DAMAGE, REPLAY_FAKE_WINDOW + 1, 0);
+
+	replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_NORMAL, 0);
+	replay_input(LOCKD_JOURNAL_LOCK_STATE, VCONFKEY_IDLE_UNLOCK, 0);
+	replay_input(LOCKD_JOURNAL_APP_DEAD, pid, 0);
+}
+
+static int _soak_run(int cycles)
+{
+	char persist[] = "/tmp/starter-persist.XXXXXX";
+	struct soak_sample base, cur, peak;
+	int warmup = cycles / 10;
+	uint64_t start_ns;
+	int i;
+
+	if (warmup < SOAK_RESTART_EVERY)
+		warmup = SOAK_RESTART_EVERY;
+	if (cycles <= warmup) {
+		fprintf(stderr, "soak needs more than %d cycles\n", warmup);
+		return 2;
+	}
+
+	if (replay_persist_file(persist) < 0)
+		return 2;
+
+	start_lock_daemon();
+
+	memset(&base, 0, sizeof(base));
+	peak = base;
+	start_ns = replay_now();
+	for (i = 0; i < cycles; i++) {
+		/* the hibernation leave path tears the daemon down and back up */
+		if (i > 0 && i % SOAK_RESTART_EVERY == 0) {
+			stop_lock_daemon();
+			start_lock_daemon();
+		}
+
+		_soak_cycle();
+
+		if (i + 1 == warmup) {
+			_soak_sample(&base);
+			peak = base;
+		} else if (i + 1 > warmup) {
+			_soak_sample(&cur);
+			if (cur.heap > peak.heap)
+				peak.heap = cur.heap;
+			if (cur.rss_kb > peak.rss_kb)
+				peak.rss_kb = cur.rss_kb;
+			if (cur.fds > peak.fds)
+				peak.fds = cur.fds;
+		}
+	}
+	stop_lock_daemon();
+
+	printf("cycles       %d (warm up %d, restart every %d)\n", cycles,
+	       warmup, SOAK_RESTART_EVERY);
+	printf("elapsed      %" PRIu64 " ms\n",
+	       (replay_now() - start_ns) / 1000000);
+	printf("locks        %" PRIu64 "\n",
+	       lockd_metrics_get()->counter[LOCKD_CNT_LOCK].value);
+	printf("visible      %" PRIu64 " (%" PRIu64 " before the map)\n",
+	       lockd_metrics_get()->hist[LOCKD_HIST_LOCK_VISIBLE].count,
+	       replay.early_visible);
+	printf("heap         %ld -> %ld bytes (peak %ld)\n", base.heap, cur.heap,
+	       peak.heap);
+	printf("rss          %ld -> %ld kB (peak %ld)\n", base.rss_kb,
+	       cur.rss_kb, peak.rss_kb);
+	printf("fds          %d -> %d (peak %d)\n", base.fds, cur.fds,
+	       peak.fds);
+	printf("lcd off      %" PRIu64 " allocation(s) in %d cycles\n",
+	       replay.allocs, cycles);
+	unlink(persist);
+
+	if (lockd_metrics_get()->counter[LOCKD_CNT_LOCK].value
+	    < (uint64_t)cycles) {
+		fprintf(stderr, "soak: only %" PRIu64 " of %d cycles locked\n",
+			lockd_metrics_get()->counter[LOCKD_CNT_LOCK].value,
+			cycles);
+		return 1;
+	}
+	if (replay.allocs) {
+		fprintf(stderr, "soak: LCD off path allocated %" PRIu64
+			" time(s)\n", replay.allocs);
+		return 1;
+	}
+	if (replay.early_visible
+	    || lockd_metrics_get()->hist[LOCKD_HIST_LOCK_VISIBLE].count
+	    != lockd_metrics_get()->hist[LOCKD_HIST_LOCK_LATENCY].count) {
+		fprintf(stderr, "soak: %" PRIu64 " lock(s) visible of %" PRIu64
+			" matched, %" PRIu64 " before the map\n",
+			lockd_metrics_get()->hist[LOCKD_HIST_LOCK_VISIBLE].count,
+			lockd_metrics_get()->hist[LOCKD_HIST_LOCK_LATENCY].count,
+			replay.early_visible);
+		return 1;
+	}
+	if (peak.heap > base.heap + SOAK_HEAP_SLACK) {
+		fprintf(stderr, "soak: heap grew by %ld bytes after warm up\n",
+			peak.heap - base.heap);
+		return 1;
+	}
+	if (peak.fds > base.fds) {
+		fprintf(stderr, "soak: %d fd(s) leaked after warm up\n",
+			peak.fds - base.fds);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int cycles;
+
+	cycles = replay_test_init(argc, argv, SOAK_CYCLES, 0);
+	if (cycles < 0)
+		return 2;
+
+	return replay_test_fini(_soak_run(cycles));
+}
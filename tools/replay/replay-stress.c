@@ -0,0 +1,183 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * replay-stress : LCD off while the main loop is busy for STRESS_LOAD_US.
+ * Reports LCD off -> launch percentiles and fails if the lock fast path is on
+ * and its p99 is not well below the load. Run it with
+ * STARTER_LOCK_FASTPATH=0 to see the main loop only figures.
+ *
+ *   replay-stress [-v] [cycles]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <vconf-keys.h>
+
+#include "lock-daemon.h"
+#include "lockd-metrics.h"
+#include "lockd-fastpath.h"
+#include "replay.h"
+
+#define STRESS_CYCLES		100
+/* how long the main loop is kept busy after each LCD off */
+#define STRESS_LOAD_US		50000
+
+/* a main loop callback that does not return for a while */
+static void _stress_spin(uint64_t usec)
+{
+	uint64_t end = replay_now() + usec * 1000;
+
+	while (replay_now() < end) ;
+}
+
+/* runs the main loop until the daemon counted a lock, or gives up */
+static int _stress_wait_lock(uint64_t locks)
+{
+	const struct lockd_metrics_page *m = lockd_metrics_get();
+	struct timespec ts = { 0, 100000 };
+	uint64_t end = replay_now() + (uint64_t)REPLAY_WAIT_US * 1000;
+
+	for (;;) {
+		replay_drain();
+		if (m->counter[LOCKD_CNT_LOCK].value > locks)
+			return 0;
+		if (replay_now() > end)
+			return -1;
+		nanosleep(&ts, NULL);
+	}
+}
+
+static int _stress_run(int cycles)
+{
+	const struct lockd_metrics_page *m = lockd_metrics_get();
+	char dir[] = "/tmp/starter-stress.XXXXXX";
+	char path[PATH_MAX];
+	struct timespec ts = { 0, 100000 };
+	uint64_t *lat;
+	uint64_t start_ns, matches, p50, p99;
+	int fast;
+	int lost = 0;
+	int n = 0;
+	int pid;
+	int i;
+
+	lat = calloc(cycles, sizeof(uint64_t));
+	if (lat == NULL || mkdtemp(dir) == NULL) {
+		fprintf(stderr, "cannot set up the stress run\n");
+		free(lat);
+		return 2;
+	}
+	snprintf(path, sizeof(path), "%s/state", dir);
+	setenv("STARTER_PM_STATE_FILE", path, 1);
+	replay_set_pm_state(path, VCONFKEY_PM_STATE_NORMAL);
+
+	start_lock_daemon();
+	fast = lockd_fastpath_enabled();
+	matches = m->counter[LOCKD_CNT_WIN_MATCH].value;
+
+	for (i = 0; i < cycles; i++) {
+		uint64_t locks = m->counter[LOCKD_CNT_LOCK].value;
+
+		replay.launch_ns = 0;
+		start_ns = replay_now();
+		replay_set_pm_state(path, VCONFKEY_PM_STATE_LCDOFF);
+
+		/* the main loop only sees the notification after its load */
+		_stress_spin(STRESS_LOAD_US);
+		replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_LCDOFF,
+			     0);
+
+		while (replay.launch_ns == 0
+		       && replay_now() - start_ns <
+		       (uint64_t)REPLAY_WAIT_US * 1000)
+			nanosleep(&ts, NULL);
+		if (replay.launch_ns == 0) {
+			lost++;
+			continue;
+		}
+		lat[n++] = (replay.launch_ns - start_ns) / 1000;
+
+		/* the lock app may show before the launch is handed back */
+		pid = replay.live_pid;
+		replay_input(LOCKD_JOURNAL_WIN_CREATE, REPLAY_FAKE_WINDOW + 1,
+			     pid);
+		replay_input(LOCKD_JOURNAL_WIN_SHOW, REPLAY_FAKE_WINDOW + 1,
+			     pid);
+		if (_stress_wait_lock(locks) < 0) {
+			lost++;
+			continue;
+		}
+
+		replay_set_pm_state(path, VCONFKEY_PM_STATE_NORMAL);
+		replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_NORMAL,
+			     0);
+		replay_input(LOCKD_JOURNAL_LOCK_STATE, VCONFKEY_IDLE_UNLOCK, 0);
+		replay_input(LOCKD_JOURNAL_APP_DEAD, pid, 0);
+		replay_drain();
+	}
+	stop_lock_daemon();
+	/* whatever was still queued must find the daemon gone */
+	replay_drain();
+
+	matches = m->counter[LOCKD_CNT_WIN_MATCH].value - matches;
+	unlink(path);
+	rmdir(dir);
+
+	p50 = replay_percentile(lat, n, 50);
+	p99 = replay_percentile(lat, n, 99);
+
+	printf("fast path    %s\n", fast ? "on" : "off");
+	printf("cycles       %d (main loop load %d us)\n", cycles,
+	       STRESS_LOAD_US);
+	printf("lcd off -> launch p50 %" PRIu64 " us, p99 %" PRIu64
+	       " us, max %" PRIu64 " us\n", p50, p99, n ? lat[n - 1] : 0);
+	printf("windows      %" PRIu64 " matched\n", matches);
+	free(lat);
+
+	if (lost) {
+		fprintf(stderr, "stress: %d of %d cycles did not lock\n", lost,
+			cycles);
+		return 1;
+	}
+	if (matches < (uint64_t)cycles) {
+		fprintf(stderr, "stress: only %" PRIu64 " of %d lock windows "
+			"matched\n", matches, cycles);
+		return 1;
+	}
+	if (fast && p99 >= STRESS_LOAD_US / 2) {
+		fprintf(stderr, "stress: p99 %" PRIu64 " us follows the main "
+			"loop load\n", p99);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int cycles;
+
+	cycles = replay_test_init(argc, argv, STRESS_CYCLES, 1);
+	if (cycles < 0)
+		return 2;
+
+	return replay_test_fini(_stress_run(cycles));
+}
@@ -0,0 +1,612 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The system stand-ins of the replay harness, see replay.h. Everything here
+ * but the noti subscriber overrides a library liblock-daemon links with.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <vconf-keys.h>
+
+#include "starter-vconf.h"
+#include "replay.h"
+
+/* ---------------------------------------------------------------------- */
+/* stand-ins : aul                                                          */
+
+int aul_launch_app(const char *appid, void *kb)
+{
+	struct lockd_journal_record *r;
+	int pid;
+
+	/* not the daemon's own app, its result is not in the journal */
+	if (strcmp(appid, REPLAY_EMERGENCY_PKGNAME) == 0) {
+		replay.emergency++;
+		return REPLAY_FAKE_PID_BASE - 1;
+	}
+
+	/* aul resets a running app instead of starting another one */
+	r = replay_pop(&replay.launch);
+	if (r != NULL)
+		pid = r->arg[0];
+	else if (replay.live_pid > 0)
+		pid = replay.live_pid;
+	else
+		pid = replay.next_fake_pid++;
+	if (pid > 0)
+		replay.live_pid = pid;
+
+	/* may be the fast path thread, the pid is there before the time */
+	__sync_synchronize();
+	replay.launch_ns = replay_now();
+
+	return pid;
+}
+
+int aul_listen_app_dead_signal(replay_dead_cb func, void *data)
+{
+	replay.dead_cb = func;
+	replay.dead_data = data;
+
+	return 0;
+}
+
+int aul_terminate_pid(int pid)
+{
+	/* the app dead signal that follows is in the journal */
+	return 0;
+}
+
+int aul_app_get_pkgname_bypid(int pid, char *pkgname, int len)
+{
+	struct lockd_journal_record *r;
+	int running;
+
+	r = replay_pop(&replay.check);
+	running = r ? r->arg[1] : (pid != 0 && pid == replay.live_pid);
+	if (!running)
+		return -1;
+
+	snprintf(pkgname, len, "%s", REPLAY_LOCK_PKGNAME);
+
+	return 0;
+}
+
+int aul_app_is_running(const char *appid)
+{
+	/* only reached when the journal said the lock app was running */
+	return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+/* stand-ins : vconf                                                        */
+
+int vconf_get_int(const char *key, int *val)
+{
+	struct lockd_journal_record *r;
+
+	if (strcmp(key, VCONFKEY_CALL_STATE) == 0) {
+		r = replay_pop(&replay.call);
+		*val = r ? r->arg[0] : VCONFKEY_CALL_OFF;
+		return 0;
+	}
+	if (strcmp(key, VCONFKEY_PM_STATE) == 0) {
+		*val = replay.pm_state;
+		return 0;
+	}
+	if (strcmp(key, VCONF_PRIVATE_LOCKSCREEN_SPECULATIVE) == 0) {
+		*val = replay.speculative;
+		return 0;
+	}
+
+	*val = 0;
+	return 0;
+}
+
+int vconf_set_int(const char *key, int val)
+{
+	struct lockd_journal_record *r;
+
+	if (strcmp(key, VCONFKEY_IDLE_LOCK_STATE) != 0)
+		return 0;
+
+	replay.set_lock_count++;
+	if (!replay.journal)
+		return 0;
+
+	r = replay_pop(&replay.set_lock);
+	if (r == NULL || r->arg[0] != val) {
+		fprintf(stderr, "diverged: lock state set to %d, journal has %d"
+			" (write #%d)\n", val, r ? r->arg[0] : -1,
+			replay.set_lock_count);
+		replay.mismatch++;
+	}
+
+	return 0;
+}
+
+char *vconf_get_str(const char *key)
+{
+	if (strcmp(key, VCONF_PRIVATE_LOCKSCREEN_EMERGENCY) == 0)
+		return strdup(REPLAY_EMERGENCY_PKGNAME);
+
+	return strdup(REPLAY_LOCK_PKGNAME);
+}
+
+char *vconf_keynode_get_str(void *node)
+{
+	return REPLAY_LOCK_PKGNAME;
+}
+
+int vconf_notify_key_changed(const char *key, replay_vconf_cb cb, void *data)
+{
+	if (strcmp(key, VCONFKEY_PM_STATE) == 0) {
+		replay.pm_cb = cb;
+		replay.pm_data = data;
+	} else if (strcmp(key, VCONFKEY_IDLE_LOCK_STATE) == 0) {
+		replay.lock_cb = cb;
+		replay.lock_data = data;
+	}
+
+	return 0;
+}
+
+int vconf_ignore_key_changed(const char *key, replay_vconf_cb cb)
+{
+	if (strcmp(key, VCONFKEY_PM_STATE) == 0 && replay.pm_cb == cb)
+		replay.pm_cb = NULL;
+	else if (strcmp(key, VCONFKEY_IDLE_LOCK_STATE) == 0
+		 && replay.lock_cb == cb)
+		replay.lock_cb = NULL;
+
+	return 0;
+}
+
+int vconf_keynode_get_int(void *node)
+{
+	return ((struct replay_keynode *)node)->val;
+}
+
+/* ---------------------------------------------------------------------- */
+/* stand-ins : ecore, ecore-x, Xlib, utilX                                  */
+
+int ECORE_X_EVENT_WINDOW_CREATE = 1001;
+int ECORE_X_EVENT_WINDOW_SHOW = 1002;
+int ECORE_EVENT_KEY_DOWN = 1003;
+int ECORE_X_EVENT_DAMAGE_NOTIFY = 1004;
+
+void *ecore_event_handler_add(int type, replay_event_cb func, const void *data)
+{
+	/* one handler per type is all the daemon needs at a time */
+	if ((type == ECORE_X_EVENT_WINDOW_CREATE && replay.create_cb)
+	    || (type == ECORE_X_EVENT_WINDOW_SHOW && replay.show_cb)
+	    || (type == ECORE_EVENT_KEY_DOWN && replay.key_cb)
+	    || (type == ECORE_X_EVENT_DAMAGE_NOTIFY && replay.damage_cb))
+		replay.handler_leaks++;
+
+	if (type == ECORE_X_EVENT_WINDOW_CREATE) {
+		replay.create_cb = func;
+		replay.create_data = (void *)data;
+		return &replay.create_cb;
+	} else if (type == ECORE_X_EVENT_WINDOW_SHOW) {
+		replay.show_cb = func;
+		replay.show_data = (void *)data;
+		return &replay.show_cb;
+	} else if (type == ECORE_EVENT_KEY_DOWN) {
+		replay.key_cb = func;
+		replay.key_data = (void *)data;
+		return &replay.key_cb;
+	} else if (type == ECORE_X_EVENT_DAMAGE_NOTIFY) {
+		replay.damage_cb = func;
+		replay.damage_data = (void *)data;
+		return &replay.damage_cb;
+	}
+
+	return NULL;
+}
+
+/* queued here, the driver runs them as the main loop would */
+void ecore_main_loop_thread_safe_call_async(replay_async_cb cb, void *data)
+{
+	pthread_mutex_lock(&replay.async_lock);
+	if (replay.n_async < REPLAY_ASYNC_MAX) {
+		replay.async[replay.n_async].cb = cb;
+		replay.async[replay.n_async].data = data;
+		replay.n_async++;
+	} else {
+		fprintf(stderr, "main loop call queue is full\n");
+	}
+	pthread_mutex_unlock(&replay.async_lock);
+}
+
+void *ecore_main_fd_handler_add(int fd, int flags, replay_fd_cb func,
+				const void *data, void *buf_func,
+				const void *buf_data)
+{
+	int i;
+
+	for (i = 0; i < REPLAY_FD_HANDLER_MAX; i++) {
+		if (replay.fdh[i].used)
+			continue;
+		replay.fdh[i].used = 1;
+		replay.fdh[i].fd = fd;
+		replay.fdh[i].cb = func;
+		replay.fdh[i].data = (void *)data;
+		return &replay.fdh[i];
+	}
+
+	return NULL;
+}
+
+replay_select_cb ecore_main_loop_select_func_get(void)
+{
+	return replay.select_func;
+}
+
+void ecore_main_loop_select_func_set(replay_select_cb func)
+{
+	replay.select_func = func;
+}
+
+void *ecore_main_fd_handler_del(void *handler)
+{
+	struct replay_fd_handler *h = handler;
+
+	if (h)
+		h->used = 0;
+
+	return NULL;
+}
+
+void *ecore_event_handler_del(void *handler)
+{
+	if (handler == &replay.create_cb)
+		replay.create_cb = NULL;
+	else if (handler == &replay.show_cb)
+		replay.show_cb = NULL;
+	else if (handler == &replay.key_cb)
+		replay.key_cb = NULL;
+	else if (handler == &replay.damage_cb)
+		replay.damage_cb = NULL;
+
+	return NULL;
+}
+
+void *ecore_x_display_get(void)
+{
+	return NULL;
+}
+
+unsigned int ecore_x_window_root_first_get(void)
+{
+	return 1;
+}
+
+unsigned int *ecore_x_window_root_list(int *num_ret)
+{
+	unsigned int *roots;
+
+	roots = malloc(sizeof(unsigned int));
+	if (roots == NULL) {
+		*num_ret = 0;
+		return NULL;
+	}
+	roots[0] = 1;
+	*num_ret = 1;
+
+	return roots;
+}
+
+void ecore_x_window_size_get(unsigned int win, int *w, int *h)
+{
+	*w = 480;
+	*h = 800;
+}
+
+/* the last window an event was sent for is the only top level window */
+unsigned int *ecore_x_window_children_get(unsigned int win, int *num)
+{
+	unsigned int *children;
+
+	*num = 0;
+	if (replay.win == 0 || replay.no_scan)
+		return NULL;
+
+	children = malloc(sizeof(unsigned int));
+	if (children == NULL)
+		return NULL;
+	children[0] = replay.win;
+	*num = 1;
+
+	return children;
+}
+
+int ecore_x_window_visible_get(unsigned int win)
+{
+	return win != replay.win || replay.win_mapped;
+}
+
+int ecore_x_damage_query(void)
+{
+	return 1;
+}
+
+unsigned int ecore_x_damage_new(unsigned int d, int level)
+{
+	replay.damage_win = d;
+
+	return REPLAY_FAKE_DAMAGE;
+}
+
+void ecore_x_damage_free(unsigned int damage)
+{
+	replay.damage_win = 0;
+}
+
+void ecore_x_damage_subtract(unsigned int damage, unsigned int repair,
+			     unsigned int parts) { }
+
+unsigned int ecore_x_window_input_new(unsigned int parent, int x, int y,
+				      int w, int h)
+{
+	return REPLAY_FAKE_WINDOW;
+}
+
+int ecore_x_netwm_pid_get(unsigned int win, int *pid)
+{
+	*pid = (win == replay.win) ? replay.win_pid : 0;
+
+	return 1;
+}
+
+void ecore_x_window_free(unsigned int win) { }
+unsigned int ecore_x_window_override_new(unsigned int parent, int x, int y,
+					 int w, int h)
+{
+	return REPLAY_FAKE_WINDOW + 2;
+}
+void ecore_x_window_background_color_set(unsigned int win, unsigned short r,
+					 unsigned short g, unsigned short b) { }
+void ecore_x_window_show(unsigned int win) { }
+void ecore_x_window_hide(unsigned int win) { }
+void ecore_x_window_raise(unsigned int win) { }
+void ecore_x_flush(void) { }
+
+/* no main loop here, timers never fire : only the ones pending are counted */
+void *ecore_timer_add(double in, void *func, const void *data)
+{
+	replay.timers++;
+	return &replay;
+}
+
+void *ecore_timer_del(void *timer)
+{
+	if (timer)
+		replay.timers--;
+	return NULL;
+}
+void ecore_x_icccm_title_set(unsigned int win, const char *t) { }
+void ecore_x_icccm_name_class_set(unsigned int win, const char *n,
+				  const char *c) { }
+void ecore_x_netwm_name_set(unsigned int win, const char *name) { }
+void ecore_x_netwm_pid_set(unsigned int win, int pid) { }
+void ecore_x_netwm_window_type_set(unsigned int win, int type) { }
+void ecore_x_window_client_sniff(unsigned int win) { }
+void ecore_x_event_mask_unset(unsigned int win, int mask) { }
+
+unsigned long XInternAtom(void *dpy, const char *name, int only_if_exists)
+{
+	return 1;
+}
+
+int XGetWindowProperty(void *dpy, unsigned long w, unsigned long property,
+		       long offset, long length, int del, unsigned long type,
+		       unsigned long *type_ret, int *format_ret,
+		       unsigned long *nitems_ret, unsigned long *bytes_ret,
+		       unsigned char **prop_ret)
+{
+	*prop_ret = NULL;
+
+	return 0;
+}
+
+int XFree(void *data)
+{
+	return 1;
+}
+
+/* unknown, the daemon falls back to unsetting its own bits */
+int XGetWindowAttributes(void *dpy, unsigned long w, void *att)
+{
+	return 0;
+}
+
+int XSelectInput(void *dpy, unsigned long w, long mask)
+{
+	return 1;
+}
+
+int XGetGeometry(void *dpy, unsigned long d, unsigned long *root, int *x,
+		 int *y, unsigned int *w, unsigned int *h, unsigned int *border,
+		 unsigned int *depth)
+{
+	*x = *y = 0;
+	*w = 480;
+	*h = 800;
+	*border = 0;
+	*depth = 24;
+
+	return 1;
+}
+
+int XTranslateCoordinates(void *dpy, unsigned long src, unsigned long dst,
+			  int sx, int sy, int *dx, int *dy, unsigned long *child)
+{
+	*dx = sx;
+	*dy = sy;
+	*child = 0;
+
+	return 1;
+}
+
+int utilx_grab_key(void *dpy, unsigned long win, const char *key, int mode)
+{
+	replay.grabs++;
+	replay.grabbed = 1;
+
+	return 0;
+}
+
+int utilx_ungrab_key(void *dpy, unsigned long win, const char *key)
+{
+	replay.grabs++;
+	replay.grabbed = 0;
+
+	return 0;
+}
+
+void utilx_set_system_notification_level(void *dpy, unsigned long win,
+					 int level) { }
+int utilx_set_window_opaque_state(void *dpy, unsigned long win, int state)
+{
+	return 1;
+}
+void utilx_set_window_effect_state(void *dpy, unsigned long win,
+				   int state) { }
+
+/* ---------------------------------------------------------------------- */
+/* stand-ins : libc                                                         */
+
+/* keep away from the live starter's shared pages */
+int shm_open(const char *name, int oflag, mode_t mode)
+{
+	errno = EACCES;
+	return -1;
+}
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static void _replay_heap_add(long n)
+{
+	__atomic_add_fetch(&replay.heap, n, __ATOMIC_RELAXED);
+}
+
+/* counted only while replay.count_allocs is set */
+void *malloc(size_t size)
+{
+	void *p;
+
+	if (replay.count_allocs)
+		replay.allocs++;
+	p = __libc_malloc(size);
+	if (p != NULL)
+		_replay_heap_add(malloc_usable_size(p));
+	return p;
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+	void *p;
+
+	if (replay.count_allocs)
+		replay.allocs++;
+	p = __libc_calloc(nmemb, size);
+	if (p != NULL)
+		_replay_heap_add(malloc_usable_size(p));
+	return p;
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	long old = ptr != NULL ? (long)malloc_usable_size(ptr) : 0;
+	void *p;
+
+	if (replay.count_allocs)
+		replay.allocs++;
+	p = __libc_realloc(ptr, size);
+	if (p != NULL)
+		_replay_heap_add((long)malloc_usable_size(p) - old);
+	else if (size == 0)
+		_replay_heap_add(-old);
+	return p;
+}
+
+void free(void *ptr)
+{
+	if (ptr != NULL)
+		_replay_heap_add(-(long)malloc_usable_size(ptr));
+	__libc_free(ptr);
+}
+
+int usleep(useconds_t usec)
+{
+	struct timespec ts;
+
+	if (replay.fast)
+		return 0;
+
+	ts.tv_sec = usec / 1000000;
+	ts.tv_nsec = (usec % 1000000) * 1000;
+	return nanosleep(&ts, NULL);
+}
+
+void lockd_log_t(char *fmt, ...)
+{
+	va_list ap;
+
+	if (!replay.verbose)
+		return;
+
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	fputc('\n', stderr);
+}
+
+int replay_noti_subscribe(const char *event, replay_noti_cb cb, void *data)
+{
+	if (strcmp(event, "power_off_start") == 0) {
+		replay.power_off_cb = cb;
+		replay.power_off_data = data;
+	}
+
+	return 0;
+}
+
+int replay_noti_unsubscribe(const char *event, replay_noti_cb cb,
+			    void *data)
+{
+	if (strcmp(event, "power_off_start") == 0
+	    && replay.power_off_cb == cb) {
+		replay.power_off_cb = NULL;
+		replay.power_off_data = NULL;
+	}
+
+	return 0;
+}
+
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * replay-suspend : LCD off, then the lock window, except every
+ * SUSPEND_MISS_EVERY cycles where it never comes. Fails if suspend was not
+ * blocked from LCD off to the window, or if a missing window did not end in
+ * the SUSPEND_TIMEOUT_MS timeout. The daemon's suspend blocker is the local
+ * stand-in unless STARTER_SUSPEND_BLOCKER says otherwise.
+ *
+ *   replay-suspend [-v] [cycles]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <vconf-keys.h>
+
+#include "lock-daemon.h"
+#include "lockd-metrics.h"
+#include "lockd-suspend.h"
+#include "replay.h"
+
+#define SUSPEND_CYCLES		100
+/* a lock app that never shows its window, and how long for */
+#define SUSPEND_MISS_EVERY	4
+#define SUSPEND_TIMEOUT_MS	20
+
+static int _suspend_run(int cycles)
+{
+	const struct lockd_metrics_page *m = lockd_metrics_get();
+	const struct lockd_metrics_hist *h;
+	char timeout[16];
+	uint64_t end;
+	int unblocked = 0;
+	int held = 0;
+	int misses = 0;
+	int pid;
+	int i;
+
+	snprintf(timeout, sizeof(timeout), "%d", SUSPEND_TIMEOUT_MS);
+	setenv("STARTER_SUSPEND_TIMEOUT_MS", timeout, 1);
+	start_lock_daemon();
+
+	for (i = 0; i < cycles; i++) {
+		replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_LCDOFF, 0);
+		pid = replay.live_pid;
+		if (!lockd_suspend_blocked())
+			unblocked++;
+
+		if (i % SUSPEND_MISS_EVERY == SUSPEND_MISS_EVERY - 1) {
+			/* the timeout is the daemon's timer fd */
+			misses++;
+			end = replay_now()
+			    + (uint64_t)SUSPEND_TIMEOUT_MS * 10 * 1000000;
+			while (lockd_suspend_blocked() && replay_now() < end)
+				replay_fd_dispatch(SUSPEND_TIMEOUT_MS);
+		} else {
+			replay_input(LOCKD_JOURNAL_WIN_CREATE,
+				     REPLAY_FAKE_WINDOW + 1, pid);
+			replay_input(LOCKD_JOURNAL_WIN_SHOW,
+				     REPLAY_FAKE_WINDOW + 1, pid);
+		}
+		if (lockd_suspend_blocked())
+			held++;
+
+		replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_NORMAL, 0);
+		replay_input(LOCKD_JOURNAL_LOCK_STATE, VCONFKEY_IDLE_UNLOCK, 0);
+		replay_input(LOCKD_JOURNAL_APP_DEAD, pid, 0);
+	}
+	stop_lock_daemon();
+
+	h = &m->hist[LOCKD_HIST_SUSPEND_BLOCK];
+	printf("cycles       %d, %d without a lock window\n", cycles, misses);
+	printf("blocked      %" PRIu64 ", timed out %" PRIu64 "\n",
+	       m->counter[LOCKD_CNT_SUSPEND_BLOCK].value,
+	       m->counter[LOCKD_CNT_SUSPEND_TIMEOUT].value);
+	printf("block held   %" PRIu64 " us on average, %" PRIu64 " us max\n",
+	       h->count ? h->sum_us / h->count : 0, h->max_us);
+
+	if (unblocked || held
+	    || m->counter[LOCKD_CNT_SUSPEND_BLOCK].value != (uint64_t)cycles
+	    || m->counter[LOCKD_CNT_SUSPEND_TIMEOUT].value != (uint64_t)misses) {
+		fprintf(stderr, "suspend: %d LCD off without the block, %d "
+			"block(s) left after the window or timeout\n",
+			unblocked, held);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int cycles;
+
+	cycles = replay_test_init(argc, argv, SUSPEND_CYCLES, 0);
+	if (cycles < 0)
+		return 2;
+
+	return replay_test_fini(_suspend_run(cycles));
+}
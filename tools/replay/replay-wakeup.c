@@ -0,0 +1,116 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * replay-wakeup : LCD off and the lock window, then WAKEUP_IDLE_MS with
+ * nothing happening, with the daemon's wakeup audit (lockd-wakeup.h) on.
+ * The main loop iterations in between go through the audit's select, as
+ * on the device, the only wakeups left out are the timeouts of the check's
+ * own wait. Fails if the screen off main loop woke up at all, or if more
+ * than the snapshot's one shot timer was pending in it.
+ *
+ *   replay-wakeup [-v] [cycles]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <vconf-keys.h>
+
+#include "lock-daemon.h"
+#include "lockd-wakeup.h"
+#include "replay.h"
+
+#define WAKEUP_CYCLES		10
+#define WAKEUP_IDLE_MS		500
+
+static int _wakeup_run(int cycles)
+{
+	uint64_t wakeups = 0;
+	uint64_t idle_ms = 0;
+	unsigned int start;
+	uint64_t end;
+	uint64_t now;
+	int timeouts;
+	int timers = 0;
+	int pid;
+	int i;
+
+	setenv("STARTER_WAKEUP_AUDIT", "1", 1);
+	start_lock_daemon();
+	if (replay.select_func == NULL) {
+		fprintf(stderr, "wakeup: the audit did not take the select\n");
+		stop_lock_daemon();
+		return 2;
+	}
+
+	for (i = 0; i < cycles; i++) {
+		replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_LCDOFF, 0);
+		pid = replay.live_pid;
+		replay_input(LOCKD_JOURNAL_WIN_CREATE, REPLAY_FAKE_WINDOW + 1, pid);
+		replay_input(LOCKD_JOURNAL_WIN_SHOW, REPLAY_FAKE_WINDOW + 1, pid);
+		replay_drain();
+
+		/* the lock is up, from here on nothing should run */
+		start = lockd_wakeup_idle_count();
+		timeouts = 0;
+		now = replay_now();
+		end = now + (uint64_t)WAKEUP_IDLE_MS * 1000000;
+		while (now < end) {
+			if (replay_fd_dispatch((end - now) / 1000000 + 1) == 0)
+				timeouts++;
+			pthread_mutex_lock(&replay.async_lock);
+			wakeups += replay.n_async;
+			pthread_mutex_unlock(&replay.async_lock);
+			replay_drain();
+			now = replay_now();
+		}
+		wakeups += lockd_wakeup_idle_count() - start - timeouts;
+		idle_ms += WAKEUP_IDLE_MS;
+		timers += replay.timers;
+
+		replay_input(LOCKD_JOURNAL_PM_STATE, VCONFKEY_PM_STATE_NORMAL, 0);
+		replay_input(LOCKD_JOURNAL_LOCK_STATE, VCONFKEY_IDLE_UNLOCK, 0);
+		replay_input(LOCKD_JOURNAL_APP_DEAD, pid, 0);
+	}
+	stop_lock_daemon();
+
+	printf("cycles       %d, %" PRIu64 " ms screen off after the lock\n",
+	       cycles, idle_ms);
+	printf("wakeups      %" PRIu64 ", %" PRIu64 ".%02" PRIu64 "/min\n",
+	       wakeups, wakeups * 60000 / idle_ms,
+	       (wakeups * 6000000 / idle_ms) % 100);
+	printf("timers       %d pending while the screen was off\n", timers);
+
+	if (wakeups || timers > cycles) {
+		fprintf(stderr, "wakeup: %" PRIu64 " screen off wakeup(s), %d "
+			"timer(s) over %d lock(s)\n", wakeups, timers, cycles);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int cycles;
+
+	cycles = replay_test_init(argc, argv, WAKEUP_CYCLES, 0);
+	if (cycles < 0)
+		return 2;
+
+	return replay_test_fini(_wakeup_run(cycles));
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+/*
+ * The harness liblock-daemon runs in for starter-replay and the lock daemon
+ * checks (replay-*, run by ctest).
+ *
+ * replay-stubs.c defines the aul, vconf, ecore-x, utilx and Xlib entry
+ * points liblock-daemon uses, the executables are linked with -rdynamic so
+ * that the daemon runs against them instead of the real system. Results
+ * that depend on the system (launched pid, running check, call state) come
+ * from the journal being replayed, or are made up when there is none.
+ * replay-fixture.c drives the daemon : inputs as the journal records them,
+ * one main loop iteration, the calls its threads post to the main loop.
+ *
+ * A check is a main() that calls replay_test_init(), runs the daemon with
+ * replay_input() and returns replay_test_fini() of its verdict : 0 passed,
+ * 1 failed, 2 could not run.
+ */
+
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/select.h>
+
+#include "lockd-journal.h"
+#include "starter-lock-control.h"
+
+#define REPLAY_FAKE_PID_BASE	10000
+#define REPLAY_FAKE_WINDOW	0x400001
+#define REPLAY_FAKE_DAMAGE	0x500001
+#define REPLAY_LOCK_PKGNAME	"org.tizen.draglock"
+#define REPLAY_EMERGENCY_PKGNAME	"org.tizen.emergency"
+/* utilX's KEY_SELECT and KEY_VOLUMEUP */
+#define REPLAY_KEY_HOME		"XF86Phone"
+#define REPLAY_KEY_VOLUME	"XF86AudioRaiseVolume"
+
+/* how long the daemon's threads and sockets get to answer */
+#define REPLAY_WAIT_US		1000000
+#define REPLAY_ASYNC_MAX	64
+#define REPLAY_FD_HANDLER_MAX	32
+
+typedef int (*replay_dead_cb) (int pid, void *data);
+typedef void (*replay_vconf_cb) (void *node, void *data);
+typedef int (*replay_event_cb) (void *data, int type, void *event);
+typedef void (*replay_noti_cb) (void *data);
+typedef void (*replay_async_cb) (void *data);
+typedef int (*replay_fd_cb) (void *data, void *handler);
+typedef int (*replay_select_cb) (int nfds, fd_set * readfds, fd_set * writefds,
+				 fd_set * exceptfds, struct timeval * timeout);
+
+/* the ecore event types, defined by the stand-ins */
+extern int ECORE_X_EVENT_WINDOW_CREATE;
+extern int ECORE_X_EVENT_WINDOW_SHOW;
+extern int ECORE_EVENT_KEY_DOWN;
+extern int ECORE_X_EVENT_DAMAGE_NOTIFY;
+
+struct replay_keynode {
+	int val;
+};
+
+/* laid out as Ecore_Event_Key, Ecore_Window is a uintptr_t */
+struct replay_key_event {
+	const char *keyname;
+	const char *key;
+	const char *string;
+	const char *compose;
+	uintptr_t window;
+	uintptr_t root_window;
+	uintptr_t event_window;
+	unsigned int timestamp;
+	unsigned int modifiers;
+	int same_screen;
+	unsigned int keycode;
+	void *data;
+};
+
+struct replay_queue {
+	uint32_t type;
+	int pos;
+};
+
+struct replay_async {
+	replay_async_cb cb;
+	void *data;
+};
+
+struct replay_fd_handler {
+	int used;
+	int fd;
+	replay_fd_cb cb;
+	void *data;
+};
+
+struct replay_state {
+	int fast;
+	int verbose;
+	/* lock state writes are checked against the journal */
+	int journal;
+	/* VCONF_PRIVATE_LOCKSCREEN_SPECULATIVE */
+	int speculative;
+	/* the journal's lock control requests go out on this */
+	int control_fd;
+
+	struct lockd_journal_record *rec;
+	int n_rec;
+
+	struct replay_queue launch;
+	struct replay_queue check;
+	struct replay_queue call;
+	struct replay_queue set_lock;
+
+	int next_fake_pid;
+	int live_pid;
+
+	unsigned int win;
+	int win_pid;
+	int win_mapped;
+	/* the screen's window list comes back empty, only ids reach windows */
+	int no_scan;
+	/* the window the daemon watches for damage */
+	unsigned int damage_win;
+	/* locks taken as visible on a paint of an unmapped window */
+	uint64_t early_visible;
+	/* event handlers added over one that was never deleted */
+	int handler_leaks;
+
+	replay_dead_cb dead_cb;
+	void *dead_data;
+	replay_vconf_cb pm_cb;
+	void *pm_data;
+	replay_vconf_cb lock_cb;
+	void *lock_data;
+	replay_event_cb create_cb;
+	void *create_data;
+	replay_event_cb show_cb;
+	void *show_data;
+	replay_noti_cb power_off_cb;
+	void *power_off_data;
+	replay_event_cb key_cb;
+	void *key_data;
+	replay_event_cb damage_cb;
+	void *damage_data;
+
+	/* utilx grab and ungrab calls, and whether a key is grabbed */
+	int grabs;
+	int grabbed;
+	int emergency;
+
+	int inputs;
+	int set_lock_count;
+	int mismatch;
+
+	int count_allocs;
+	uint64_t allocs;
+	/* bytes live through the allocator entry points of the stand-ins */
+	long heap;
+
+	/* PM state behind vconf_get_int, and the last launch */
+	volatile int pm_state;
+	volatile uint64_t launch_ns;
+
+	/* calls the daemon's threads posted to the main loop */
+	pthread_mutex_t async_lock;
+	struct replay_async async[REPLAY_ASYNC_MAX];
+	int n_async;
+
+	/* fd handlers, run by replay_fd_dispatch() */
+	struct replay_fd_handler fdh[REPLAY_FD_HANDLER_MAX];
+	/* what replay_fd_dispatch() waits in, the daemon's wakeup audit if set */
+	replay_select_cb select_func;
+	/* timers added and not deleted, they would each wake the main loop */
+	int timers;
+};
+
+extern struct replay_state replay;
+
+/* replay-stubs.c */
+int replay_noti_subscribe(const char *event, replay_noti_cb cb, void *data);
+int replay_noti_unsubscribe(const char *event, replay_noti_cb cb,
+			    void *data);
+
+/* replay-fixture.c */
+void replay_setup(int fastpath);
+int replay_test_init(int argc, char *argv[], int cycles, int fastpath);
+int replay_test_fini(int ret);
+
+uint64_t replay_now(void);
+void replay_wait(uint64_t start_ns, uint64_t ts_ns);
+struct lockd_journal_record *replay_pop(struct replay_queue *q);
+void replay_dispatch(struct lockd_journal_record *r);
+void replay_input(uint32_t type, int a0, int a1);
+int replay_fd_dispatch(int timeout_ms);
+void replay_drain(void);
+void replay_set_pm_state(const char *path, int val);
+int replay_persist_file(char *path);
+uint64_t replay_percentile(uint64_t *v, int n, int pct);
+
+int replay_control_connect(void);
+int replay_control_wait(int fd, int type,
+			struct starter_lock_control_msg *msg);
+int replay_control_request(int fd, int type,
+			   struct starter_lock_control_msg *reply);
+
+#endif				/* __REPLAY_H__ */
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * starter-metrics : dump the counters and latency histograms that starter
+ * publishes in its shared metrics page.
+ *
+ *   starter-metrics        summary
+ *   starter-metrics -v     summary and every histogram bucket
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <inttypes.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "lockd-metrics.h"
+
+static uint64_t _now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint64_t _bucket_limit(const struct lockd_metrics_page *page, int i)
+{
+	return (uint64_t)page->bucket_base_us << i;
+}
+
+/* upper bound of the bucket that holds the given percentile, capped by max */
+static uint64_t _percentile(const struct lockd_metrics_page *page,
+			    const struct lockd_metrics_hist *h, int pct)
+{
+	uint64_t target;
+	uint64_t seen = 0;
+	int i;
+
+	if (h->count == 0)
+		return 0;
+
+	target = (h->count * pct + 99) / 100;
+	for (i = 0; i < (int)page->n_buckets - 1; i++) {
+		seen += h->bucket[i];
+		if (seen >= target)
+			break;
+	}
+
+	if (i < (int)page->n_buckets - 1 && _bucket_limit(page, i) < h->max_us)
+		return _bucket_limit(page, i);
+
+	return h->max_us;
+}
+
+static void _dump(const struct lockd_metrics_page *page, int verbose)
+{
+	const struct lockd_metrics_hist *h;
+	int i, j;
+
+	printf("uptime %" PRIu64 " s\n", (_now_us() - page->start_us) / 1000000);
+
+	printf("\n%-24s %12s\n", "counter", "value");
+	for (i = 0; i < (int)page->n_counters; i++)
+		printf("%-24s %12" PRIu64 "\n", page->counter[i].name,
+		       page->counter[i].value);
+
+	printf("\n%-24s %8s %10s %10s %10s %10s %10s\n", "histogram (usec)",
+	       "count", "avg", "p50", "p90", "p99", "max");
+	for (i = 0; i < (int)page->n_hists; i++) {
+		h = &page->hist[i];
+		printf("%-24s %8" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10"
+		       PRIu64 " %10" PRIu64 " %10" PRIu64 "\n", h->name,
+		       h->count, h->count ? h->sum_us / h->count : 0,
+		       _percentile(page, h, 50), _percentile(page, h, 90),
+		       _percentile(page, h, 99), h->max_us);
+
+		if (!verbose)
+			continue;
+
+		for (j = 0; j < (int)page->n_buckets; j++) {
+			if (h->bucket[j] == 0)
+				continue;
+			if (j == (int)page->n_buckets - 1)
+				printf("    >= %-10" PRIu64 " %10" PRIu64 "\n",
+				       _bucket_limit(page, j - 1), h->bucket[j]);
+			else
+				printf("    <  %-10" PRIu64 " %10" PRIu64 "\n",
+				       _bucket_limit(page, j), h->bucket[j]);
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	struct lockd_metrics_page *page;
+	int verbose = 0;
+	int fd;
+
+	if (argc > 1) {
+		if (strcmp(argv[1], "-v") != 0) {
+			fprintf(stderr, "usage: %s [-v]\n", argv[0]);
+			return 1;
+		}
+		verbose = 1;
+	}
+
+	fd = shm_open(LOCKD_METRICS_SHM_NAME, O_RDONLY, 0);
+	if (fd < 0) {
+		fprintf(stderr, "starter metrics page is not available\n");
+		return 1;
+	}
+
+	page = mmap(NULL, sizeof(struct lockd_metrics_page), PROT_READ,
+		    MAP_SHARED, fd, 0);
+	close(fd);
+	if (page == MAP_FAILED) {
+		fprintf(stderr, "cannot map starter metrics page\n");
+		return 1;
+	}
+
+	if (page->magic != LOCKD_METRICS_MAGIC
+	    || page->version != LOCKD_METRICS_VERSION
+	    || page->n_counters != LOCKD_CNT_MAX
+	    || page->n_hists != LOCKD_HIST_MAX) {
+		fprintf(stderr, "starter metrics page layout mismatch\n");
+		munmap(page, sizeof(struct lockd_metrics_page));
+		return 1;
+	}
+
+	_dump(page, verbose);
+
+	munmap(page, sizeof(struct lockd_metrics_page));
+
+	return 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * starter-replay : feed a lock daemon journal (STARTER_JOURNAL) back into
+ * liblock-daemon.
+ *
+ *   starter-replay [-f] [-v] <journal>
+ *
+ *   -f   as fast as possible instead of the recorded pace
+ *   -v   print the daemon's debug log on stderr
+ *
+ * The daemon runs against the stand-ins of the replay harness (replay/),
+ * without the fast path : it has to act synchronously on each input.
+ * Launched pids, running checks and the call state are answered from the
+ * journal, and every lock state the daemon writes is compared with the
+ * recorded one.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+
+#include "lock-daemon.h"
+#include "lockd-journal.h"
+#include "lockd-metrics.h"
+#include "replay.h"
+
+static int _replay_load(const char *path)
+{
+	struct lockd_journal_header hdr;
+	struct stat st;
+	int fd;
+	ssize_t len;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "cannot open %s: %s\n", path, strerror(errno));
+		return -1;
+	}
+
+	if (fstat(fd, &st) < 0
+	    || read(fd, &hdr, sizeof(hdr)) != sizeof(hdr)
+	    || hdr.magic != LOCKD_JOURNAL_MAGIC
+	    || hdr.version != LOCKD_JOURNAL_VERSION) {
+		fprintf(stderr, "%s is not a lock daemon journal\n", path);
+		close(fd);
+		return -1;
+	}
+
+	replay.n_rec = (st.st_size - sizeof(hdr))
+	    / sizeof(struct lockd_journal_record);
+	replay.rec = calloc(replay.n_rec + 1,
+			    sizeof(struct lockd_journal_record));
+	if (replay.rec == NULL) {
+		close(fd);
+		return -1;
+	}
+
+	len = read(fd, replay.rec,
+		   replay.n_rec * sizeof(struct lockd_journal_record));
+	close(fd);
+	if (len < 0) {
+		fprintf(stderr, "cannot read %s\n", path);
+		return -1;
+	}
+	replay.n_rec = len / sizeof(struct lockd_journal_record);
+
+	return 0;
+}
+
+static void _replay_report(uint64_t elapsed_ns)
+{
+	const struct lockd_metrics_page *m = lockd_metrics_get();
+	const struct lockd_metrics_hist *h = &m->hist[LOCKD_HIST_LOCK_LATENCY];
+	const struct lockd_metrics_hist *v = &m->hist[LOCKD_HIST_LOCK_VISIBLE];
+	struct lockd_journal_record *r;
+	int missing = 0;
+
+	/* lock state writes the daemon should have made but did not */
+	while ((r = replay_pop(&replay.set_lock)) != NULL)
+		missing++;
+	if (missing) {
+		fprintf(stderr, "diverged: %d recorded lock state write(s) "
+			"did not happen\n", missing);
+		replay.mismatch += missing;
+	}
+
+	printf("records      %d\n", replay.n_rec);
+	printf("inputs       %d\n", replay.inputs);
+	printf("elapsed      %" PRIu64 ".%06" PRIu64 " s\n",
+	       elapsed_ns / 1000000000, (elapsed_ns / 1000) % 1000000);
+	printf("locks        %" PRIu64 "\n", m->counter[LOCKD_CNT_LOCK].value);
+	printf("unlocks      %" PRIu64 "\n",
+	       m->counter[LOCKD_CNT_UNLOCK].value);
+	printf("lock latency %" PRIu64 " samples, avg %" PRIu64 " us, max %"
+	       PRIu64 " us\n", h->count, h->count ? h->sum_us / h->count : 0,
+	       h->max_us);
+	printf("lock visible %" PRIu64 " samples, avg %" PRIu64 " us, max %"
+	       PRIu64 " us\n", v->count, v->count ? v->sum_us / v->count : 0,
+	       v->max_us);
+	printf("divergences  %d\n", replay.mismatch);
+}
+
+int main(int argc, char *argv[])
+{
+	uint64_t start_ns;
+	int opt;
+	int i;
+
+	while ((opt = getopt(argc, argv, "fv")) != -1) {
+		switch (opt) {
+		case 'f':
+			replay.fast = 1;
+			break;
+		case 'v':
+			replay.verbose = 1;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-f] [-v] <journal>\n",
+				argv[0]);
+			return 2;
+		}
+	}
+	if (optind >= argc) {
+		fprintf(stderr, "usage: %s [-f] [-v] <journal>\n", argv[0]);
+		return 2;
+	}
+
+	replay_setup(0);
+
+	if (_replay_load(argv[optind]) < 0)
+		return 2;
+
+	replay.journal = 1;
+	replay.launch.type = LOCKD_JOURNAL_LAUNCH;
+	replay.check.type = LOCKD_JOURNAL_CHECK_LOCK;
+	replay.call.type = LOCKD_JOURNAL_CALL_STATE;
+	replay.set_lock.type = LOCKD_JOURNAL_SET_LOCK_STATE;
+
+	start_lock_daemon();
+
+	start_ns = replay_now();
+	for (i = 0; i < replay.n_rec; i++) {
+		if (!replay.fast)
+			replay_wait(start_ns, replay.rec[i].ts_ns);
+		replay_dispatch(&replay.rec[i]);
+	}
+
+	_replay_report(replay_now() - start_ns);
+
+	free(replay.rec);
+
+	return replay.mismatch ? 1 : 0;
+}
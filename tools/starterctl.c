@@ -0,0 +1,192 @@
+/*
+ * Copyright 2012  Samsung Electronics Co., Ltd
+ *
+ * Licensed under the Flora License, Version 1.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.tizenopensource.org/license
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * starterctl : drive the lock daemon over its control socket
+ * (starter-lock-control.h).
+ *
+ *   starterctl lock      lock now, and wait for the lock state to follow
+ *   starterctl unlock    unlock, root or the lock app only
+ *   starterctl status    the lock state and the lock app
+ *   starterctl watch     the state, then every change until interrupted
+ *
+ * Exits with 0 on success, 1 if starter refused or cannot be reached.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <vconf-keys.h>
+
+#include "starter-lock-control.h"
+
+/* how long lock waits for the state to change */
+#define LOCK_WAIT_SEC	3
+
+static uint64_t _now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void _print(const struct starter_lock_control_msg *msg)
+{
+	struct timespec ts;
+
+	if (msg->type == STARTER_LOCK_CONTROL_EVENT) {
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		printf("[%ld.%06ld] ", (long)ts.tv_sec, ts.tv_nsec / 1000);
+	}
+
+	if (msg->state == VCONFKEY_IDLE_LOCK)
+		printf("locked, lock app pid %d\n", msg->pid);
+	else
+		printf("unlocked\n");
+	fflush(stdout);
+}
+
+static int _watch(int fd)
+{
+	struct starter_lock_control_msg msg;
+	struct timeval tv = { 0, 0 };
+
+	if (starter_lock_control_request(fd, STARTER_LOCK_CONTROL_SUBSCRIBE,
+					 &msg) < 0)
+		return -1;
+	_print(&msg);
+
+	/* events come when they come, no timeout */
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+	while (starter_lock_control_recv(fd, &msg) >= 0) {
+		if (msg.type == STARTER_LOCK_CONTROL_EVENT)
+			_print(&msg);
+	}
+
+	/* starter went away */
+	return -1;
+}
+
+/* the request goes on fd, the lock state comes on a subscription */
+static int _lock(int fd)
+{
+	struct starter_lock_control_msg msg;
+	struct timeval tv = { LOCK_WAIT_SEC, 0 };
+	uint64_t start;
+	int sub;
+
+	sub = starter_lock_control_connect();
+	if (sub < 0
+	    || starter_lock_control_request(sub,
+					    STARTER_LOCK_CONTROL_SUBSCRIBE,
+					    &msg) < 0) {
+		fprintf(stderr, "starter lock control is not available\n");
+		return 1;
+	}
+	setsockopt(sub, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+	memset(&msg, 0, sizeof(msg));
+	start = _now_us();
+	if (starter_lock_control_request(fd, STARTER_LOCK_CONTROL_LOCK,
+					 &msg) < 0 || msg.error != 0) {
+		fprintf(stderr, "lock refused : %s\n",
+			msg.error ? strerror(-msg.error) : "no reply");
+		close(sub);
+		return 1;
+	}
+
+	/* a lock app that was already up is only brought back */
+	while (msg.state != VCONFKEY_IDLE_LOCK) {
+		if (starter_lock_control_recv(sub, &msg) <= 0) {
+			fprintf(stderr, "lock requested, still unlocked "
+				"(call in progress?)\n");
+			close(sub);
+			return 1;
+		}
+	}
+	close(sub);
+
+	printf("locked in %" PRIu64 " us, lock app pid %d\n",
+	       _now_us() - start, msg.pid);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	static const struct {
+		const char *name;
+		int type;
+	} cmd[] = {
+		{ "lock", STARTER_LOCK_CONTROL_LOCK },
+		{ "unlock", STARTER_LOCK_CONTROL_UNLOCK },
+		{ "status", STARTER_LOCK_CONTROL_STATUS },
+		{ "watch", STARTER_LOCK_CONTROL_SUBSCRIBE },
+	};
+	struct starter_lock_control_msg reply;
+	int type = 0;
+	int fd;
+	int i;
+
+	for (i = 0; argc == 2 && i < (int)(sizeof(cmd) / sizeof(cmd[0])); i++) {
+		if (strcmp(argv[1], cmd[i].name) == 0)
+			type = cmd[i].type;
+	}
+	if (type == 0) {
+		fprintf(stderr, "usage: %s lock|unlock|status|watch\n",
+			argv[0]);
+		return 1;
+	}
+
+	fd = starter_lock_control_connect();
+	if (fd < 0) {
+		fprintf(stderr, "starter lock control is not available\n");
+		return 1;
+	}
+
+	if (type == STARTER_LOCK_CONTROL_SUBSCRIBE) {
+		_watch(fd);
+		close(fd);
+		return 1;
+	}
+
+	if (type == STARTER_LOCK_CONTROL_LOCK) {
+		i = _lock(fd);
+		close(fd);
+		return i;
+	}
+
+	if (starter_lock_control_request(fd, type, &reply) < 0) {
+		fprintf(stderr, "no reply from starter\n");
+		close(fd);
+		return 1;
+	}
+	close(fd);
+
+	if (reply.error != 0) {
+		fprintf(stderr, "%s refused : %s\n", argv[1],
+			strerror(-reply.error));
+		return 1;
+	}
+	_print(&reply);
+
+	return 0;
+}
@@ -0,0 +1,63 @@
+#!/bin/sh
+#
+# startup-report.sh : dynamic linking cost of two builds of starter, e.g. a
+# plain one and a STARTER_STARTUP_OPTIMIZED one.
+#
+#   tools/startup-report.sh <baseline build dir> <optimized build dir> [runs]
+#
+# For starter and liblock-daemon : relocations (relative ones apart), PLT
+# slots and exported symbols. Then the dynamic loader's own accounting
+# (LD_DEBUG=statistics) and the wall time of the replay-restart check,
+# which loads liblock-daemon and brings the lock daemon up and down, median
+# of [runs] (default 21).
+#
+
+if [ $# -lt 2 ]; then
+	echo "usage: $0 <baseline build dir> <optimized build dir> [runs]" >&2
+	exit 2
+fi
+
+RUNS=${3:-21}
+
+median()
+{
+	sort -n | awk '{ v[NR] = $1 } END { print v[int((NR + 1) / 2)] }'
+}
+
+objects()
+{
+	for f in lock-mgr/liblock-daemon.so boot-mgr/starter; do
+		[ -f "$1/$f" ] || continue
+		total=$(readelf -rW "$1/$f" | grep -c ' R_')
+		relative=$(readelf -rW "$1/$f" | grep -c '_RELATIVE')
+		plt=$(readelf -rW "$1/$f" | grep -c '_JUMP_SLOT')
+		exported=$(nm -D --defined-only "$1/$f" | wc -l)
+		printf "  %-26s relocs %5d (relative %5d, plt %4d) exported %4d\n" \
+			"$(basename "$f")" "$total" "$relative" "$plt" "$exported"
+	done
+}
+
+startup()
+{
+	replay="$1/tools/replay-restart"
+
+	LD_DEBUG=statistics "$replay" 1 2>&1 >/dev/null \
+		| awk -F: '/total startup time/ { t = $3 }
+			/final number of relocations:/ { r = $3 }
+			END { printf "  loader  %s,%s relocations\n", t, r }'
+
+	i=0
+	while [ $i -lt "$RUNS" ]; do
+		s=$(date +%s%N)
+		"$replay" 1 > /dev/null 2>&1
+		e=$(date +%s%N)
+		echo $(((e - s) / 1000))
+		i=$((i + 1))
+	done | median | awk '{ printf "  restart %d us (median)\n", $1 }'
+}
+
+for b in "$1" "$2"; do
+	echo "$b"
+	objects "$b"
+	startup "$b"
+done